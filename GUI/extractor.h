@@ -2,19 +2,46 @@
 #define EXTRACTOR_H
 
 #include <string>
-#include <fstream>
 #include <vector>
 #include <filesystem>
 #include <iostream>
-#include <sstream>
 #include <algorithm>
+#include <climits>
+#include <map>
+#include "trace_reader.h"
+#include "collective_match.h"
+#include "symbolizer.h"
+#include "sample_attribution.h"
 
 struct TraceItem {
     std::string name;
     long long start;
     long long end;
+    int comm = -1;
     std::vector<int> dests;
     bool marks = 0;
+    int instance = -1;  // индекс в GetInstances() для коллективов
+    int depth = -1;     // пользовательский регион: глубина вложенности, иначе -1
+    std::string call_site;  // функция, вызвавшая MPI (MPITRACE_CONTEXT), иначе пусто
+    // Снимки стека (MPITRACE_SAMPLE_US) в промежутке счёта после события:
+    // число снимков по функции у вершины стека, gap_end - время последнего
+    std::map<std::string, int> gap_samples;
+    long long gap_end = 0;
+};
+
+// Показание счётчиков памяти (MPITRACE_HEAP): ступенька до следующего показания
+struct CounterPoint {
+    long long time;
+    unsigned long long live;
+    unsigned long long peak;
+};
+
+// Экземпляр коллектива для отрисовки одной связью вместо стрелок к каждому участнику (мкс)
+struct InstanceSpan {
+    int first_trace;
+    int last_trace;
+    long long last_entry;
+    long long first_exit;
 };
 
 class extractor
@@ -22,52 +49,112 @@ class extractor
 private:
     std::string _path;
     std::vector<std::vector<TraceItem>> _traces;
+    std::vector<std::vector<CounterPoint>> _counters;
     std::vector<long long int> _starts;
+    std::vector<InstanceSpan> _instances;
     size_t _count_trace = 0;
 
 public:
     extractor(std::string path) : _path(path){
         std::string file_name = _path + "/trace_rank_";
+        std::vector<TraceReader> readers;
         while (std::filesystem::exists(file_name + std::to_string(_count_trace))){
-           extract_data(file_name + std::to_string(_count_trace++));
+           readers.emplace_back();
+           extract_data(readers.back(), file_name + std::to_string(_count_trace++));
         }
         _count_trace--;
         correct_data();
+        match_instances(readers);
         print();
     }
 
-    void extract_data(std::string path){
-        std::ifstream file(path);
-
-        if (!file.is_open()){
-            std::cerr << "can not open file\n";
+    void extract_data(TraceReader& reader, std::string path){
+        // Нечитаемая трасса остаётся пустой строкой: векторы рангов выровнены
+        // с readers, а LLONG_MAX не выбирается началом отсчёта в correct_data
+        if (!reader.open(path)) {
+            std::cerr << reader.error() << "\n";
+            _starts.push_back(LLONG_MAX);
+            _traces.emplace_back();
+            _counters.emplace_back();
+            return;
         }
+        if (!reader.error().empty()) std::cerr << reader.error() << "\n";
 
-        std::string first_line;
-        if (!std::getline(file, first_line)) std::cerr << "file is empty\n";
+        _starts.push_back(reader.system_start_us);
 
-        size_t pos = first_line.find(":");
-        if (pos != std::string::npos){
-            long long int start = std::stoll(first_line.substr(pos + 1));
-            _starts.push_back(start);
-        }
-
-        std::string line;
         std::vector<TraceItem> trace;
-        while (std::getline(file, line)) {
+        std::vector<CounterPoint> counters;
+        trace.reserve(reader.events.size());
+        Symbolizer symbols(reader.modules);
+        std::vector<int> item_of(reader.events.size(), -1);
+        for (size_t j = 0; j < reader.events.size(); j++) {
+            const EventRecord& event = reader.events[j];
+            // Завершения неблокирующих операций - отметки без длительности, не рисуются
+            if (event.flags & COMPLETION) continue;
+            if (event.flags & COUNTER) {
+                counters.push_back({reader.to_ns(event.start) / 1000, event.bytes, event.offset});
+                continue;
+            }
             TraceItem item;
-            std::istringstream iss(line);
-            if (!(iss >> item.name >> item.start >> item.end)) std::cerr << "can not parse data\n";
-
-            int dest;
-            while (iss >> dest) item.dests.push_back(dest);
-
+            item.name = (event.flags & FUNCTION) ? symbols.resolve(event.offset) : reader.name(event);
+            item.start = reader.to_ns(event.start) / 1000;
+            item.end = reader.to_ns(event.end) / 1000;
+            item.comm = static_cast<int32_t>(event.comm);
+            if (event.flags & REGION) item.depth = static_cast<int>(event.data);
+            // Дерево пишется в конце: у оборванной трассы его может не быть
+            if (reader.contexts[j] < reader.context_nodes.size()) item.call_site = symbols.resolve(reader.context_nodes[reader.contexts[j]].address);
+            // Участники коллектива связываются через экземпляр (GetInstances), без списка получателей
+            if (!(event.flags & INSTANCE) && event.peer >= 0) item.dests.push_back(event.peer);
+            item_of[j] = static_cast<int>(trace.size());
             trace.push_back(item);
-
+        }
+        // Снимок вне вызовов (в промежутке или только внутри региона) относится
+        // к промежутку после последнего завершившегося события потока
+        std::vector<SampleOwner> owners = attribute_samples(reader);
+        for (size_t k = 0; k < owners.size(); k++) {
+            const StackSample& sample = reader.samples[k];
+            const SampleOwner& owner = owners[k];
+            if (sample.frames.empty() || owner.after == NO_EVENT || item_of[owner.after] < 0) continue;
+            if (owner.inside != NO_EVENT && !(reader.events[owner.inside].flags & REGION)) continue;
+            // Ближайшая к вершине функция с символом: внутренние адреса
+            // разделяемых библиотек без .symtab не дают имени
+            std::string function;
+            for (uint64_t frame : sample.frames) {
+                if (!(function = symbols.function(frame)).empty()) break;
+            }
+            if (function.empty()) function = symbols.resolve(sample.frames.front());
+            TraceItem& item = trace[item_of[owner.after]];
+            item.gap_samples[function]++;
+            item.gap_end = std::max<long long>(item.gap_end, reader.to_ns(sample.time) / 1000);
         }
         _traces.push_back(trace);
+        // Показания разных потоков перемежаются
+        std::sort(counters.begin(), counters.end(), [](const CounterPoint& a, const CounterPoint& b) {
+            return a.time < b.time;
+        });
+        _counters.push_back(counters);
+    }
 
-        file.close();
+    // Номер события в трассе не совпадает с номером TraceItem (COMPLETION и COUNTER пропущены)
+    void match_instances(const std::vector<TraceReader>& readers){
+        std::vector<std::vector<int>> item_of(readers.size());
+        for (size_t i = 0; i < readers.size(); i++){
+            item_of[i].assign(readers[i].events.size(), -1);
+            int item = 0;
+            for (size_t j = 0; j < readers[i].events.size(); j++){
+                if (!(readers[i].events[j].flags & (COMPLETION | COUNTER))) item_of[i][j] = item++;
+            }
+        }
+        for (const CollectiveInstance& instance : match_collectives(readers)){
+            InstanceSpan span{INT_MAX, -1, instance.last_entry / 1000, instance.first_exit / 1000};
+            for (const CollectiveInstance::Member& member : instance.members){
+                span.first_trace = std::min(span.first_trace, member.rank);
+                span.last_trace = std::max(span.last_trace, member.rank);
+                int item = item_of[member.rank][member.event];
+                if (item >= 0 && static_cast<size_t>(member.rank) < _traces.size()) _traces[member.rank][item].instance = static_cast<int>(_instances.size());
+            }
+            _instances.push_back(span);
+        }
     }
 
     void correct_data(){
@@ -80,15 +167,22 @@ public:
             for (size_t j = 0; j < _traces[i].size(); j++){
                 _traces[i][j].start += offset;
                 _traces[i][j].end += offset;
+                if (_traces[i][j].gap_end) _traces[i][j].gap_end += offset;
             }
+            for (CounterPoint& point : _counters[i]) point.time += offset;
         }
     }
 
     const std::vector<std::vector<TraceItem>>& GetTraces() const { return _traces;}
+    const std::vector<InstanceSpan>& GetInstances() const { return _instances;}
+    const std::vector<std::vector<CounterPoint>>& GetCounters() const { return _counters;}
     long long int GetMaxEnd() const {
         long long int max = 0;
+        // События в файле идут в порядке записи, не по времени (Init - последним)
         for (size_t i = 0; i < _traces.size(); i++){
-            if (_traces[i].back().end > max) max = _traces[i].back().end;
+            for (const TraceItem& item : _traces[i]){
+                if (item.end > max) max = item.end;
+            }
         }
         return max;
     }
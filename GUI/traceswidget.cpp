@@ -5,6 +5,8 @@ TracesWidget::TracesWidget(QWidget *parent)
     , ext("D:/institute/profiling-tools/overloading/with system_clock/build/traces1")
 {
     _traces = ext.GetTraces();
+    _instances = ext.GetInstances();
+    _counters = ext.GetCounters();
     _maxEnd = ext.GetMaxEnd();
     setMouseTracking(true);
 }
@@ -85,6 +87,27 @@ void TracesWidget::paintEvent(QPaintEvent *event) {
             int x_start = item.start * pixel_per_microsecond;
             int item_width = (item.end - item.start) * pixel_per_microsecond;
 
+            // Регионы - полосы в промежутке под строкой, по уровню вложенности
+            if (item.depth >= 0) {
+                if ((item.depth + 1) * height_region > height_spacer) continue;
+                painter.save();
+                painter.setPen(QPen(Qt::darkGreen, 1));
+                painter.setBrush(QBrush(QColor(200, 240, 200)));
+                QRect band(x_start, y_start + height_item + item.depth * height_region, std::max(item_width, 1), height_region);
+                painter.drawRect(band);
+                painter.scale(1.0 / _currentScale, 1.0);
+                if (band.width() * _currentScale > 30) {
+                    painter.setPen(QPen(Qt::black, 1));
+                    QFont font = painter.font();
+                    font.setPointSize(6);
+                    painter.setFont(font);
+                    QRect textRect(band.x() * _currentScale, band.y(), band.width() * _currentScale, band.height());
+                    painter.drawText(textRect, Qt::AlignCenter, QString::fromStdString(item.name));
+                }
+                painter.restore();
+                continue;
+            }
+
             if (item_width * _currentScale < 2) {
                 item_width = 2 / _currentScale;
             }
@@ -97,7 +120,7 @@ void TracesWidget::paintEvent(QPaintEvent *event) {
             painter.setBrush(QBrush(QColor(200, 220, 255)));
             for (int trace_dest: item.dests){
                 for (int index = 0; index < _traces[trace_dest].size(); index++){
-                    if (item.name == "Send" && _traces[trace_dest][index].name == "Recv" && !_traces[trace_dest][index].marks && _traces[trace_dest][index].dests.at(0) == number_trace){
+                    if (item.name == "Send" && _traces[trace_dest][index].name == "Recv" && !_traces[trace_dest][index].marks && !_traces[trace_dest][index].dests.empty() && _traces[trace_dest][index].dests.at(0) == number_trace){
                         QPoint start = QPoint(x_start + item_width, y_start + height_item / 2);
                         QPoint end = QPoint();
                         auto item_dest = _traces[trace_dest][index];
@@ -132,6 +155,7 @@ void TracesWidget::paintEvent(QPaintEvent *event) {
                 painter.setPen(QPen(Qt::black, 1));
                 QString text = QString::fromStdString(item.name) +
                                QString("\n%1µs").arg(item.end - item.start);
+                if (!item.call_site.empty()) text += "\n" + QString::fromStdString(item.call_site);
                 painter.drawText(textRect, Qt::AlignCenter, text);
             }
 
@@ -139,6 +163,65 @@ void TracesWidget::paintEvent(QPaintEvent *event) {
         }
     }
 
+    // Снимки стека в промежутке счёта - полоса внизу строки от конца события
+    // до последнего снимка с самой частой функцией на вершине стека
+    for (size_t number_trace = 0; number_trace < _traces.size(); ++number_trace) {
+        int y_start = _timeScaleHeight + _timeTextHeight + number_trace * (height_item + height_spacer);
+        for (const auto& item : _traces[number_trace]) {
+            if (item.gap_samples.empty()) continue;
+            auto top = std::max_element(item.gap_samples.begin(), item.gap_samples.end(), [](const auto& a, const auto& b) {
+                return a.second < b.second;
+            });
+            int total = 0;
+            for (const auto& function : item.gap_samples) total += function.second;
+            int x_start = item.end * pixel_per_microsecond;
+            int gap_width = std::max<int>((item.gap_end - item.end) * pixel_per_microsecond, 2 / _currentScale);
+            QRect band(x_start, y_start + height_item - height_region * 2, gap_width, height_region * 2);
+            painter.save();
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(QBrush(QColor(255, 165, 0, 120)));
+            painter.drawRect(band);
+            painter.scale(1.0 / _currentScale, 1.0);
+            if (band.width() * _currentScale > 30) {
+                painter.setPen(QPen(Qt::black, 1));
+                QFont font = painter.font();
+                font.setPointSize(6);
+                painter.setFont(font);
+                QRect textRect(band.x() * _currentScale, band.y(), band.width() * _currentScale, band.height());
+                painter.drawText(textRect, Qt::AlignCenter, QString("%1 (%2/%3)").arg(QString::fromStdString(top->first)).arg(top->second).arg(total));
+            }
+            painter.restore();
+        }
+    }
+
+    // Занятая память - ступенчатая линия по высоте строки, максимум ранга - верх строки
+    painter.setPen(QPen(Qt::darkMagenta, 1));
+    painter.setBrush(Qt::NoBrush);
+    for (size_t number_trace = 0; number_trace < _counters.size() && number_trace < _traces.size(); ++number_trace) {
+        const std::vector<CounterPoint>& points = _counters[number_trace];
+        if (points.empty() || !points.back().peak) continue;
+        int y_bottom = _timeScaleHeight + _timeTextHeight + number_trace * (height_item + height_spacer) + height_item;
+        double scale = static_cast<double>(height_item) / points.back().peak;
+        QPolygon line;
+        for (size_t i = 0; i < points.size(); ++i) {
+            int x = points[i].time * pixel_per_microsecond;
+            int y = y_bottom - static_cast<int>(points[i].live * scale);
+            if (i) line << QPoint(x, line.last().y());
+            line << QPoint(x, y);
+        }
+        painter.drawPolyline(line);
+    }
+
+    // Коллектив - одна линия через всех участников в момент входа последнего из них
+    painter.setPen(QPen(Qt::darkRed, 2));
+    for (const InstanceSpan& span : _instances) {
+        if (span.first_trace == span.last_trace) continue;
+        int x = span.last_entry * pixel_per_microsecond;
+        int y_first = _timeScaleHeight + _timeTextHeight + span.first_trace * (height_item + height_spacer) + height_item / 2;
+        int y_last = _timeScaleHeight + _timeTextHeight + span.last_trace * (height_item + height_spacer) + height_item / 2;
+        painter.drawLine(x, y_first, x, y_last);
+    }
+
     painter.restore();
 
     painter.setPen(Qt::red);
@@ -20,12 +20,15 @@ class TracesWidget : public QWidget
     Q_OBJECT
 private:
     std::vector<std::vector<TraceItem>> _traces;
+    std::vector<InstanceSpan> _instances;
+    std::vector<std::vector<CounterPoint>> _counters;
     extractor ext;
 
     const int height_item = 150;
     const int height_spacer = 50;
     const int _timeScaleHeight = 30;
     const int _timeTextHeight = 15;
+    const int height_region = 10;   // полоса региона под строкой трассы, вложенные - ниже
 
     double pixel_per_microsecond = 0.1;
     double _currentScale = 1.0;
@@ -0,0 +1,146 @@
+#pragma once
+#include <pthread.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "trace_format.h"
+
+// Дерево вызовов ранга (MPITRACE_CONTEXT - глубина пути, 0 - выключено).
+// На каждом вызове MPI путь снимается проходом по цепочке указателей кадров
+// (нужен -fno-omit-frame-pointer у приложения) и сводится к узлу дерева:
+// в записи события остаётся только номер узла, дерево пишется один раз
+// секцией CONTEXTS, имена восстанавливаются после запуска по MODULES.
+//
+// Путь ищется в кэше потока по хешу адресов возврата, поэтому повторный
+// вызов с того же места стоит прохода по кадрам и одного сравнения.
+// Совпадение 64-битных хешей разных путей не проверяется.
+class CallingContexts {
+private:
+    static constexpr uint32_t MAX_DEPTH = 64;
+    static constexpr size_t CACHE_SIZE = 1024;
+
+    struct CacheEntry {
+        uint64_t hash;
+        uint32_t node;
+    };
+    inline static thread_local CacheEntry _cache[CACHE_SIZE] = {};
+
+    // Границы стека потока: кадр за ними обрывает путь, а не роняет процесс
+    struct StackBounds {
+        uintptr_t low;
+        uintptr_t high;
+        bool known;
+    };
+    inline static thread_local StackBounds _stack = {};
+
+    uint32_t _depth = 0;
+    uintptr_t _own_low = 0;   // кадры самой библиотеки в начале пути пропускаются
+    uintptr_t _own_high = 0;
+
+    struct ChildKey {
+        uint32_t parent;
+        uint64_t address;
+        bool operator==(const ChildKey& other) const {
+            return parent == other.parent && address == other.address;
+        }
+    };
+    struct ChildHash {
+        size_t operator()(const ChildKey& key) const {
+            return mix(key.parent, key.address);
+        }
+    };
+
+    // Дерево меняется только при промахе кэша
+    std::vector<ContextNode> _nodes;
+    std::unordered_map<ChildKey, uint32_t, ChildHash> _children;
+    std::mutex _mutex;
+
+    static const StackBounds& stack() {
+        if (!_stack.known) {
+            _stack.known = true;
+            pthread_attr_t attr;
+            if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+                void* base = nullptr;
+                size_t size = 0;
+                if (pthread_attr_getstack(&attr, &base, &size) == 0) {
+                    _stack.low = reinterpret_cast<uintptr_t>(base);
+                    _stack.high = _stack.low + size;
+                }
+                pthread_attr_destroy(&attr);
+            }
+        }
+        return _stack;
+    }
+
+    static uint64_t mix(uint64_t hash, uint64_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    // Путь от корня к листу (path[0] - место вызова)
+    uint32_t insert(const uintptr_t* path, uint32_t depth) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint32_t node = NO_CONTEXT;
+        for (uint32_t i = depth; i-- > 0;) {
+            auto [it, added] = _children.try_emplace({node, path[i]}, static_cast<uint32_t>(_nodes.size()));
+            if (added) _nodes.push_back({node, path[i]});
+            node = it->second;
+        }
+        return node;
+    }
+
+public:
+    // own - любой адрес внутри libmpitrace
+    void init(const std::vector<ModuleDefinition>& modules, uintptr_t own) {
+        const char* value = std::getenv("MPITRACE_CONTEXT");
+        long depth = value ? std::atol(value) : 0;
+        _depth = depth > 0 ? static_cast<uint32_t>(std::min<long>(depth, MAX_DEPTH)) : 0;
+        for (const ModuleDefinition& module : modules) {
+            if (own >= module.low && own < module.high) {
+                _own_low = module.low;
+                _own_high = module.high;
+            }
+        }
+    }
+
+    bool enabled() const {
+        return _depth > 0;
+    }
+
+    // frame - __builtin_frame_address(0) обёртки. Может выделять память
+    // (первый вызов в потоке, новый путь): вызывающий защищает её от
+    // перехвата malloc.
+    uint32_t capture(const void* frame) {
+        const StackBounds& bounds = stack();
+        uintptr_t path[MAX_DEPTH];
+        uint32_t depth = 0;
+        uint64_t hash = 0;
+        uintptr_t fp = reinterpret_cast<uintptr_t>(frame);
+        while (depth < _depth && fp % sizeof(uintptr_t) == 0 && fp >= bounds.low &&
+               fp + 2 * sizeof(uintptr_t) <= bounds.high) {
+            const uintptr_t* record = reinterpret_cast<const uintptr_t*>(fp);
+            uintptr_t caller = record[0];
+            uintptr_t ret = record[1];
+            if (!ret) break;
+            if (depth || ret < _own_low || ret >= _own_high) {
+                path[depth++] = ret - 1;
+                hash = mix(hash, ret);
+            }
+            if (caller <= fp) break;
+            fp = caller;
+        }
+        if (!depth) return NO_CONTEXT;
+        hash = mix(hash, depth);
+        CacheEntry& entry = _cache[hash & (CACHE_SIZE - 1)];
+        if (entry.hash != hash || !hash) entry = {hash, insert(path, depth)};
+        return entry.node;
+    }
+
+    // После остановки записи: узлы больше не добавляются
+    const std::vector<ContextNode>& nodes() const {
+        return _nodes;
+    }
+};
@@ -0,0 +1,36 @@
+#include <mpi.h>
+#include <iostream>
+#include <iomanip>
+#include "clock_policy.h"
+
+// Стоимость одного чтения часов для каждой политики, нс/вызов
+template <class ClockPolicy>
+void measure(int iterations) {
+    volatile uint64_t sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink = ClockPolicy::now();
+    }
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+    std::cout << std::setw(22) << std::left << ClockPolicy::name << std::fixed << std::setprecision(2) << ns << " ns\n";
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank == 0) {
+        const int iterations = 10000000;
+        measure<WtimeClock>(iterations);
+        measure<SteadyClock>(iterations);
+        measure<SystemClock>(iterations);
+        measure<MonotonicRawClock>(iterations);
+#ifdef MPITRACE_HAVE_TSC
+        measure<TscClock>(iterations);
+#endif
+    }
+    MPI_Finalize();
+    return 0;
+}
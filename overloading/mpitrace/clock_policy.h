@@ -0,0 +1,124 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <mpi.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MPITRACE_HAVE_TSC 1
+#endif
+
+// Политики часов для TraceCollector<ClockPolicy>.
+// now() вызывается в горячем пути каждой обёртки и возвращает "тики"
+// в собственных единицах часов. Перевод в наносекунды делается только
+// при записи трассы: либо постоянным множителем ns_per_tick,
+// либо по калибровке (calibrated = true), если active() - иначе тики
+// уже являются наносекундами.
+
+// Опорные часы для калибровки
+inline uint64_t monotonic_ns() noexcept {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// MPI_Wtime: секунды в double, храним как наносекунды
+struct WtimeClock {
+    static constexpr const char* name = "MPI_Wtime";
+    static constexpr bool calibrated = false;
+    static constexpr double ns_per_tick = 1.0;
+
+    static uint64_t now() noexcept {
+        return static_cast<uint64_t>(PMPI_Wtime() * 1e9);
+    }
+};
+
+struct SteadyClock {
+    static constexpr const char* name = "steady_clock";
+    static constexpr bool calibrated = false;
+    static constexpr double ns_per_tick = 1.0;
+
+    static uint64_t now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+struct SystemClock {
+    static constexpr const char* name = "system_clock";
+    static constexpr bool calibrated = false;
+    static constexpr double ns_per_tick = 1.0;
+
+    static uint64_t now() noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Не подвержены коррекции NTP, но идут через vDSO как и steady_clock
+struct MonotonicRawClock {
+    static constexpr const char* name = "CLOCK_MONOTONIC_RAW";
+    static constexpr bool calibrated = false;
+    static constexpr double ns_per_tick = 1.0;
+
+    static uint64_t now() noexcept {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+    }
+};
+
+#ifdef MPITRACE_HAVE_TSC
+// TSC пригоден как часы, только если его частота не зависит от
+// P-state (constant_tsc) и он не останавливается в C-state (nonstop_tsc)
+inline bool invariant_tsc_available() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 5, "flags") != 0) continue;
+        line += ' ';
+        return line.find(" constant_tsc ") != std::string::npos &&
+               line.find(" nonstop_tsc ") != std::string::npos;
+    }
+    return false;
+}
+
+// Счётчик тактов: одна инструкция rdtscp, частота определяется калибровкой
+// по CLOCK_MONOTONIC. Без invariant TSC - steady_clock в наносекундах.
+struct TscClock {
+    static constexpr const char* name = "rdtscp";
+    static constexpr const char* fallback_name = "steady_clock";
+    static constexpr bool calibrated = true;
+    static constexpr double ns_per_tick = 1.0;
+
+    static inline const bool invariant = invariant_tsc_available();
+
+    static bool active() noexcept {
+        return invariant;
+    }
+
+    static uint64_t now() noexcept {
+        if (__builtin_expect(invariant, 1)) {
+            unsigned int aux;
+            return __rdtscp(&aux);
+        }
+        return SteadyClock::now();
+    }
+};
+#endif
+
+// Часы выбираются при сборке: -DMPITRACE_CLOCK=<wtime|steady|system|monotonic_raw|tsc>
+#if defined(MPITRACE_CLOCK_WTIME)
+using DefaultClock = WtimeClock;
+#elif defined(MPITRACE_CLOCK_SYSTEM)
+using DefaultClock = SystemClock;
+#elif defined(MPITRACE_CLOCK_MONOTONIC_RAW)
+using DefaultClock = MonotonicRawClock;
+#elif defined(MPITRACE_CLOCK_TSC) && defined(MPITRACE_HAVE_TSC)
+using DefaultClock = TscClock;
+#else
+using DefaultClock = SteadyClock;
+#endif
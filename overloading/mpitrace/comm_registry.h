@@ -0,0 +1,161 @@
+#pragma once
+#include <mpi.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "id_agreement.h"
+#include "last_hit.h"
+#include "trace_format.h"
+
+// Кэш сведений о коммуникаторе, чтобы обёртки не вызывали MPI в горячем пути
+struct CommInfo {
+    uint32_t id;
+    int rank;
+    int size;
+    bool is_inter;
+    std::vector<int> world_ranks;         // ранг в коммуникаторе -> ранг в MPI_COMM_WORLD
+    std::vector<int> remote_world_ranks;  // то же для удалённой группы интеркоммуникатора
+    uint32_t collectives = 0;             // номер следующего коллектива на коммуникаторе
+
+    // Ранг партнёра в точечных операциях: у интеркоммуникатора - в удалённой группе
+    int peer_to_world(int peer) const {
+        const std::vector<int>& table = is_inter ? remote_world_ranks : world_ranks;
+        return peer >= 0 && peer < static_cast<int>(table.size()) ? table[peer] : peer;
+    }
+
+    int to_world(int rank) const {
+        return rank >= 0 && rank < size ? world_ranks[rank] : rank;
+    }
+};
+
+// Таблица перевода всех рангов группы в ранги MPI_COMM_WORLD
+inline std::vector<int> translate_to_world(MPI_Group group) {
+    int size;
+    PMPI_Group_size(group, &size);
+    MPI_Group world_group;
+    PMPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    std::vector<int> local_ranks(size), world_ranks(size);
+    for (int i = 0; i < size; i++) local_ranks[i] = i;
+    PMPI_Group_translate_ranks(group, size, local_ranks.data(), world_group, world_ranks.data());
+    PMPI_Group_free(&world_group);
+    return world_ranks;
+}
+
+// Реестр коммуникаторов, ключ - дескриптор MPI_Comm.
+// Заполняется перехватом функций создания (Comm_split, Comm_dup, ...),
+// очищается в Comm_free/Comm_disconnect.
+//
+// Идентификатор согласуется при создании (IdAgreement), поэтому у двух
+// коммуникаторов с общим процессом идентификаторы различны.
+// Коммуникаторы, созданные в обход перехвата (Comm_idup, Comm_accept, ...),
+// регистрируются при первом использовании с локальным идентификатором
+// (бит LOCAL_ID).
+//
+// Потоки (MPI_THREAD_MULTIPLE): таблица под shared_mutex, который берётся
+// только при промахе кэша последнего коммуникатора. Узлы unordered_map не
+// перемещаются при вставке, поэтому указатели из кэша остаются верными.
+class CommRegistry {
+private:
+    std::unordered_map<MPI_Comm, CommInfo> _comms;
+    std::vector<CommDefinition> _definitions;  // все зарегистрированные, для секции COMMS
+    IdAgreement _ids;
+    std::atomic<uint32_t> _next_local_id{0};
+    mutable std::shared_mutex _mutex;
+
+    // Последний найденный коммуникатор: коллективы подряд обычно на одном
+    LastHit<CommRegistry, MPI_Comm, CommInfo*> _last;
+
+    // Под исключительной блокировкой
+    CommInfo& insert(MPI_Comm comm, uint32_t id) {
+        CommInfo& info = _comms[comm];
+        info.id = id;
+        PMPI_Comm_rank(comm, &info.rank);
+        PMPI_Comm_size(comm, &info.size);
+
+        int is_inter = 0;
+        PMPI_Comm_test_inter(comm, &is_inter);
+        info.is_inter = is_inter;
+
+        MPI_Group group;
+        PMPI_Comm_group(comm, &group);
+        info.world_ranks = translate_to_world(group);
+        PMPI_Group_free(&group);
+        if (is_inter) {
+            PMPI_Comm_remote_group(comm, &group);
+            info.remote_world_ranks = translate_to_world(group);
+            PMPI_Group_free(&group);
+        }
+
+        info.collectives = 0;
+        _definitions.push_back({id, std::vector<int32_t>(info.world_ranks.begin(), info.world_ranks.end())});
+        return info;
+    }
+
+public:
+    static constexpr uint32_t LOCAL_ID = 0x40000000u;
+    static constexpr uint32_t NO_ID = 0xFFFFFFFFu;
+    static constexpr uint32_t WORLD_ID = 0;
+    static constexpr uint32_t SELF_ID = 1;
+
+    void init() {
+        std::unique_lock lock(_mutex);
+        insert(MPI_COMM_WORLD, WORLD_ID);
+        insert(MPI_COMM_SELF, SELF_ID);
+        _ids.reset(SELF_ID + 1);
+    }
+
+    // Коллективная операция над новым коммуникатором
+    void add(MPI_Comm comm) {
+        if (comm == MPI_COMM_NULL) return;
+        int is_inter = 0;
+        PMPI_Comm_test_inter(comm, &is_inter);
+        uint32_t id;
+        if (is_inter) {
+            // Allreduce на интеркоммуникаторе даёт максимум другой группы
+            id = LOCAL_ID | _next_local_id.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            id = _ids.agree(comm);
+        }
+        std::unique_lock lock(_mutex);
+        insert(comm, id);
+    }
+
+    void remove(MPI_Comm comm) {
+        std::unique_lock lock(_mutex);
+        _last.invalidate();
+        _comms.erase(comm);
+    }
+
+    // Без регистрации: коммуникатор мог быть уже освобождён
+    const CommInfo* find(MPI_Comm comm) const {
+        std::shared_lock lock(_mutex);
+        auto it = _comms.find(comm);
+        return it != _comms.end() ? &it->second : nullptr;
+    }
+
+    CommInfo& get(MPI_Comm comm) {
+        CommInfo* info;
+        if (_last.find(comm, info)) return *info;
+        uint64_t generation = _last.generation();
+        {
+            std::shared_lock lock(_mutex);
+            auto it = _comms.find(comm);
+            info = it != _comms.end() ? &it->second : nullptr;
+        }
+        if (!info) {
+            std::unique_lock lock(_mutex);
+            auto it = _comms.find(comm);
+            info = it != _comms.end() ? &it->second : &insert(comm, LOCAL_ID | _next_local_id.fetch_add(1, std::memory_order_relaxed));
+        }
+        _last.remember(comm, info, generation);
+        return *info;
+    }
+
+    // После MPI_Finalize, других потоков уже нет
+    const std::vector<CommDefinition>& definitions() const {
+        return _definitions;
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "trace_format.h"
+
+// Имена событий хранятся один раз, в записи - только индекс.
+// Индекс 16-битный: имена сверх OVERFLOW_NAME получают общее имя
+// OVERFLOW_NAME (последний индекс) и только считаются.
+class StringTable {
+private:
+    std::vector<std::string> _strings;
+    std::unordered_map<std::string, uint16_t> _index;
+    uint64_t _overflow = 0;
+
+public:
+    static constexpr uint16_t OVERFLOW_NAME = UINT16_MAX;
+
+    uint16_t intern(std::string_view str) {
+        auto it = _index.find(std::string(str));
+        if (it != _index.end()) return it->second;
+        if (_strings.size() >= OVERFLOW_NAME) {
+            if (_strings.size() == OVERFLOW_NAME) _strings.emplace_back("(names overflow)");
+            _overflow++;
+            return OVERFLOW_NAME;
+        }
+        uint16_t id = static_cast<uint16_t>(_strings.size());
+        _strings.emplace_back(str);
+        _index.emplace(_strings.back(), id);
+        return id;
+    }
+
+    const std::string& operator[](uint16_t id) const {
+        return _strings[id];
+    }
+
+    const std::vector<std::string>& strings() const {
+        return _strings;
+    }
+
+    size_t size() const {
+        return _strings.size();
+    }
+
+    // Сколько раз имя не поместилось в таблицу
+    uint64_t overflow() const {
+        return _overflow;
+    }
+};
+
+// Буфер фиксированной ёмкости; заполненный буфер целиком передаётся на запись
+struct EventBuffer {
+    std::vector<EventRecord> events;
+    std::vector<uint32_t> contexts;  // узел дерева вызовов события (calling_context.h)
+    size_t capacity;
+
+    // Имена, появившиеся после передачи предыдущего буфера
+    uint32_t first_name = 0;
+    std::vector<std::string> names;
+
+    explicit EventBuffer(size_t capacity) : capacity(capacity) {
+        events.reserve(capacity);
+        contexts.reserve(capacity);
+    }
+
+    bool full() const {
+        return events.size() >= capacity;
+    }
+
+    void clear() {
+        events.clear();
+        contexts.clear();
+        names.clear();
+    }
+};
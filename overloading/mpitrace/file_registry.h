@@ -0,0 +1,211 @@
+#pragma once
+#include <mpi.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "comm_registry.h"
+#include "trace_format.h"
+
+// Что делает вызов MPI-IO с данными файла
+enum class FileOp {
+    READ,
+    WRITE,
+    SYNC,
+};
+
+enum class FileMode {
+    INDEPENDENT,
+    COLLECTIVE,     // *_all, *_ordered, File_sync
+};
+
+// Смещение в строках MPI_FILE_IO, кроме явного offset у *_at
+constexpr MPI_Offset FILE_POINTER = -1;     // индивидуальный указатель файла
+constexpr MPI_Offset UNKNOWN_OFFSET = -2;   // общий указатель или *_end
+
+// Накопленное одним процессом по одному файлу
+struct FileStats {
+    uint64_t read_bytes = 0;
+    uint64_t write_bytes = 0;
+    uint64_t ticks = 0;     // время внутри вызовов чтения, записи и sync
+    uint64_t calls = 0;
+};
+
+struct FileInfo {
+    uint32_t id;
+    uint32_t comm;          // идентификатор коммуникатора файла в CommRegistry
+    std::string name;
+    FileStats stats;
+    uint32_t collectives = 0;   // номер следующего коллективного вызова на файле
+};
+
+// Реестр открытых файлов, ключ - дескриптор MPI_File. Идентификатор
+// согласуется так же, как у окон (IdAgreement по коммуникатору файла).
+// Закрытые файлы остаются в сводке до MPI_Finalize.
+// Блокировки - как в CommRegistry; счётчики файла, в который пишут
+// несколько потоков, увеличиваются атомарно.
+class FileRegistry {
+private:
+    std::unordered_map<MPI_File, FileInfo> _files;
+    std::vector<FileInfo> _closed;
+    IdAgreement _ids;
+    std::atomic<uint32_t> _next_local_id{0};
+    std::shared_mutex _mutex;
+
+    LastHit<FileRegistry, MPI_File, FileInfo*> _last;
+
+    // Под исключительной блокировкой
+    FileInfo& insert(MPI_File fh, uint32_t id, uint32_t comm, const char* name) {
+        FileInfo& info = _files[fh];
+        info = FileInfo{id, comm, name ? name : "", {}, 0};
+        return info;
+    }
+
+    static void add_relaxed(uint64_t& counter, uint64_t value) {
+        __atomic_fetch_add(&counter, value, __ATOMIC_RELAXED);
+    }
+
+    // Сводка процесса в ns: id, имя, байты чтения и записи, время, число вызовов
+    std::string serialize(double ns_per_tick) const {
+        std::string out;
+        auto put = [&](const FileInfo& info) {
+            put_varint(out, info.id);
+            put_string(out, info.name);
+            put_varint(out, info.stats.read_bytes);
+            put_varint(out, info.stats.write_bytes);
+            put_varint(out, static_cast<uint64_t>(info.stats.ticks * ns_per_tick));
+            put_varint(out, info.stats.calls);
+        };
+        for (const FileInfo& info : _closed) put(info);
+        for (const auto& [fh, info] : _files) {
+            if (info.stats.calls) put(info);
+        }
+        return out;
+    }
+
+public:
+    // Коллективная операция над comm (открытие файла тоже коллективное)
+    void add(MPI_File fh, MPI_Comm comm, uint32_t comm_id, const char* name) {
+        if (fh == MPI_FILE_NULL) return;
+        uint32_t id = _ids.agree(comm);
+        std::unique_lock lock(_mutex);
+        insert(fh, id, comm_id, name);
+    }
+
+    void close(MPI_File fh) {
+        std::unique_lock lock(_mutex);
+        _last.invalidate();
+        auto it = _files.find(fh);
+        if (it == _files.end()) return;
+        if (it->second.stats.calls) _closed.push_back(std::move(it->second));
+        _files.erase(it);
+    }
+
+    FileInfo& get(MPI_File fh) {
+        FileInfo* info;
+        if (_last.find(fh, info)) return *info;
+        uint64_t generation = _last.generation();
+        {
+            std::shared_lock lock(_mutex);
+            auto it = _files.find(fh);
+            info = it != _files.end() ? &it->second : nullptr;
+        }
+        if (!info) {
+            std::unique_lock lock(_mutex);
+            auto it = _files.find(fh);
+            info = it != _files.end() ? &it->second
+                                      : &insert(fh, CommRegistry::LOCAL_ID | _next_local_id.fetch_add(1, std::memory_order_relaxed),
+                                                CommRegistry::NO_ID, nullptr);
+        }
+        _last.remember(fh, info, generation);
+        return *info;
+    }
+
+    void account(MPI_File fh, FileOp op, uint64_t bytes, uint64_t ticks) {
+        if (fh == MPI_FILE_NULL) return;
+        FileStats& stats = get(fh).stats;
+        if (op == FileOp::READ) add_relaxed(stats.read_bytes, bytes);
+        if (op == FileOp::WRITE) add_relaxed(stats.write_bytes, bytes);
+        add_relaxed(stats.ticks, ticks);
+        add_relaxed(stats.calls, 1);
+    }
+
+    // Сводка по файлам на ранге 0 (коллективная операция, до PMPI_Finalize).
+    // Файл - пара (идентификатор, имя); скорость - объём всех рангов, делённый
+    // на время самого медленного ранга, поэтому отстающий ранг сразу виден.
+    void write_summary(const std::string& path, double ns_per_tick, MPI_Comm comm) const {
+        int rank, size;
+        PMPI_Comm_rank(comm, &rank);
+        PMPI_Comm_size(comm, &size);
+
+        std::string local = serialize(ns_per_tick);
+        int local_size = static_cast<int>(local.size());
+        std::vector<int> sizes(rank == 0 ? size : 0), displs(sizes.size());
+        PMPI_Gather(&local_size, 1, MPI_INT, sizes.data(), 1, MPI_INT, 0, comm);
+        int total = 0;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            displs[i] = total;
+            total += sizes[i];
+        }
+        std::string all(total, '\0');
+        PMPI_Gatherv(local.data(), local_size, MPI_CHAR, all.data(), sizes.data(), displs.data(), MPI_CHAR, 0, comm);
+        if (rank != 0 || total == 0) return;
+
+        struct Summary {
+            int ranks = 0;
+            uint64_t calls = 0, read_bytes = 0, write_bytes = 0, total_ns = 0;
+            uint64_t min_ns = UINT64_MAX, max_ns = 0, min_bytes = UINT64_MAX, max_bytes = 0;
+            int slowest = -1;
+        };
+        std::map<std::pair<uint32_t, std::string>, Summary> files;
+        for (int r = 0; r < size; r++) {
+            const uint8_t* begin = reinterpret_cast<const uint8_t*>(all.data()) + displs[r];
+            ByteReader in{begin, begin + sizes[r]};
+            while (in.ok && in.pos != in.end) {
+                uint32_t id = static_cast<uint32_t>(in.varint());
+                std::string name = in.string();
+                FileStats stats;
+                stats.read_bytes = in.varint();
+                stats.write_bytes = in.varint();
+                stats.ticks = in.varint();
+                stats.calls = in.varint();
+                if (!in.ok) break;
+
+                Summary& s = files[{id, name}];
+                uint64_t bytes = stats.read_bytes + stats.write_bytes;
+                s.ranks++;
+                s.calls += stats.calls;
+                s.read_bytes += stats.read_bytes;
+                s.write_bytes += stats.write_bytes;
+                s.total_ns += stats.ticks;
+                s.min_ns = std::min(s.min_ns, stats.ticks);
+                if (stats.ticks >= s.max_ns) {
+                    s.max_ns = stats.ticks;
+                    s.slowest = r;
+                }
+                s.min_bytes = std::min(s.min_bytes, bytes);
+                s.max_bytes = std::max(s.max_bytes, bytes);
+            }
+        }
+
+        std::ofstream file(path);
+        file << "# per-file MPI-IO summary, times in ns, rate = bytes / max_ns (GB/s)\n";
+        file << "# id ranks calls read_bytes write_bytes total_ns min_ns max_ns slowest_rank"
+                " min_bytes max_bytes rate name\n";
+        for (const auto& [key, s] : files) {
+            double rate = s.max_ns ? static_cast<double>(s.read_bytes + s.write_bytes) / s.max_ns : 0.0;
+            file << key.first << " " << s.ranks << " " << s.calls
+                 << " " << s.read_bytes << " " << s.write_bytes
+                 << " " << s.total_ns << " " << s.min_ns << " " << s.max_ns << " " << s.slowest
+                 << " " << s.min_bytes << " " << s.max_bytes
+                 << " " << rate << " " << key.second << "\n";
+        }
+    }
+};
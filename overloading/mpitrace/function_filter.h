@@ -0,0 +1,103 @@
+#pragma once
+#include <fnmatch.h>
+#include <algorithm>
+#include <link.h>
+#include <unistd.h>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "symbolizer.h"
+#include "trace_format.h"
+
+// Карта загрузки процесса для секции MODULES: объекты, подгруженные
+// позже (dlopen), в неё не попадают
+inline std::vector<ModuleDefinition> capture_load_map() {
+    std::vector<ModuleDefinition> modules;
+    dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) {
+        ModuleDefinition module{info->dlpi_name ? info->dlpi_name : "", info->dlpi_addr, UINT64_MAX, 0};
+        for (int i = 0; i < info->dlpi_phnum; i++) {
+            const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+            if (segment.p_type != PT_LOAD) continue;
+            module.low = std::min<uint64_t>(module.low, info->dlpi_addr + segment.p_vaddr);
+            module.high = std::max<uint64_t>(module.high, info->dlpi_addr + segment.p_vaddr + segment.p_memsz);
+        }
+        // Пустое имя у самой программы
+        if (module.path.empty() && static_cast<std::vector<ModuleDefinition>*>(data)->empty()) {
+            char path[4096];
+            ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+            if (length > 0) module.path.assign(path, length);
+        }
+        if (!module.path.empty() && module.low < module.high) {
+            static_cast<std::vector<ModuleDefinition>*>(data)->push_back(std::move(module));
+        }
+        return 0;
+    }, &modules);
+    return modules;
+}
+
+// Отбор функций -finstrument-functions по раскрытым именам, шаблоны fnmatch
+// через запятую: MPITRACE_FUNCTIONS_INCLUDE (если задан, пишутся только
+// подходящие) и MPITRACE_FUNCTIONS_EXCLUDE (важнее include).
+// Решение по адресу кэшируется в потоке, поэтому имя ищется один раз на
+// функцию и поток, а исключённая мелкая функция стоит одного сравнения.
+class FunctionFilter {
+private:
+    struct CacheEntry {
+        uint64_t address;
+        bool accepted;
+    };
+    static constexpr size_t CACHE_SIZE = 1024;
+    inline static thread_local CacheEntry _cache[CACHE_SIZE] = {};
+
+    bool _enabled = false;
+    std::vector<std::string> _include;
+    std::vector<std::string> _exclude;
+    std::unique_ptr<Symbolizer> _symbols;
+    std::mutex _mutex;  // только промах кэша: Symbolizer читает символы модулей лениво
+
+    static std::vector<std::string> split(const char* value) {
+        std::vector<std::string> patterns;
+        if (!value) return patterns;
+        std::string list(value);
+        size_t begin = 0;
+        while (begin <= list.size()) {
+            size_t end = list.find(',', begin);
+            if (end == std::string::npos) end = list.size();
+            if (end > begin) patterns.push_back(list.substr(begin, end - begin));
+            begin = end + 1;
+        }
+        return patterns;
+    }
+
+    static bool matches(const std::vector<std::string>& patterns, const std::string& name) {
+        for (const std::string& pattern : patterns) {
+            if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0) return true;
+        }
+        return false;
+    }
+
+    bool decide(uint64_t address) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::string name = _symbols->function(address);
+        if (matches(_exclude, name)) return false;
+        return _include.empty() || matches(_include, name);
+    }
+
+public:
+    void init(const std::vector<ModuleDefinition>& modules) {
+        _include = split(std::getenv("MPITRACE_FUNCTIONS_INCLUDE"));
+        _exclude = split(std::getenv("MPITRACE_FUNCTIONS_EXCLUDE"));
+        _enabled = !_include.empty() || !_exclude.empty();
+        if (_enabled) _symbols = std::make_unique<Symbolizer>(modules);
+    }
+
+    bool accept(uint64_t address) {
+        if (!_enabled) return true;
+        CacheEntry& entry = _cache[(address >> 4) & (CACHE_SIZE - 1)];
+        if (entry.address != address) entry = {address, decide(address)};
+        return entry.accepted;
+    }
+};
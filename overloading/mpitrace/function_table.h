@@ -0,0 +1,130 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Номера перехватываемых функций по mpi_functions.def. В отличие от
+// индексов StringTable они одинаковы во всех процессах, поэтому по ним
+// профили складываются между рангами.
+enum FunctionId : uint16_t {
+#define MPI_FUNCTION(func_name, ...) FUNCTION_##func_name,
+#define MPI_COMM_CREATE(func_name, ...) FUNCTION_##func_name,
+#define MPI_COMM_FREE(func_name, ...) FUNCTION_##func_name,
+#define MPI_REQUEST_POST(func_name, ...) FUNCTION_##func_name,
+#define MPI_REQUEST_INIT(func_name, ...) FUNCTION_##func_name,
+#define MPI_WITH_STATUS(func_name, ...) FUNCTION_##func_name,
+#define MPI_PROBE_POLL(func_name, ...) FUNCTION_##func_name,
+#define MPI_MATCHED_PROBE(func_name, ...) FUNCTION_##func_name,
+#define MPI_MATCHED_PROBE_POLL(func_name, ...) FUNCTION_##func_name,
+#define MPI_SENDRECV(func_name, ...) FUNCTION_##func_name,
+#define MPI_TYPE_FREE(func_name, ...) FUNCTION_##func_name,
+#define MPI_WIN_CREATE(func_name, ...) FUNCTION_##func_name,
+#define MPI_WIN_FREE(func_name, ...) FUNCTION_##func_name,
+#define MPI_RMA_OP(func_name, ...) FUNCTION_##func_name,
+#define MPI_RMA_REQUEST(func_name, ...) FUNCTION_##func_name,
+#define MPI_RMA_EPOCH(func_name, ...) FUNCTION_##func_name,
+#define MPI_FILE_OPEN(func_name, ...) FUNCTION_##func_name,
+#define MPI_FILE_CLOSE(func_name, ...) FUNCTION_##func_name,
+#define MPI_FILE_CALL(func_name, ...) FUNCTION_##func_name,
+#define MPI_FILE_IO(func_name, ...) FUNCTION_##func_name,
+#define MPI_FILE_IO_REQUEST(func_name, ...) FUNCTION_##func_name,
+#include "mpi_functions.def"
+#undef MPI_FUNCTION
+#undef MPI_COMM_CREATE
+#undef MPI_COMM_FREE
+#undef MPI_REQUEST_POST
+#undef MPI_REQUEST_INIT
+#undef MPI_WITH_STATUS
+#undef MPI_PROBE_POLL
+#undef MPI_MATCHED_PROBE
+#undef MPI_MATCHED_PROBE_POLL
+#undef MPI_SENDRECV
+#undef MPI_TYPE_FREE
+#undef MPI_WIN_CREATE
+#undef MPI_WIN_FREE
+#undef MPI_RMA_OP
+#undef MPI_RMA_REQUEST
+#undef MPI_RMA_EPOCH
+#undef MPI_FILE_OPEN
+#undef MPI_FILE_CLOSE
+#undef MPI_FILE_CALL
+#undef MPI_FILE_IO
+#undef MPI_FILE_IO_REQUEST
+    // Функции, обёртки которых написаны вручную
+    FUNCTION_Init,
+    FUNCTION_Finalize,
+    FUNCTION_Pcontrol,
+    FUNCTION_Start,
+    FUNCTION_Startall,
+    FUNCTION_Wait,
+    FUNCTION_Waitall,
+    FUNCTION_Waitany,
+    FUNCTION_Waitsome,
+    FUNCTION_Test,
+    FUNCTION_Testall,
+    FUNCTION_Testany,
+    FUNCTION_Testsome,
+    FUNCTION_Request_free,
+    FUNCTION_Win_test,
+    FUNCTION_COUNT
+};
+
+inline constexpr const char* function_names[FUNCTION_COUNT] = {
+#define MPI_FUNCTION(func_name, ...) #func_name,
+#define MPI_COMM_CREATE(func_name, ...) #func_name,
+#define MPI_COMM_FREE(func_name, ...) #func_name,
+#define MPI_REQUEST_POST(func_name, ...) #func_name,
+#define MPI_REQUEST_INIT(func_name, ...) #func_name,
+#define MPI_WITH_STATUS(func_name, ...) #func_name,
+#define MPI_PROBE_POLL(func_name, ...) #func_name,
+#define MPI_MATCHED_PROBE(func_name, ...) #func_name,
+#define MPI_MATCHED_PROBE_POLL(func_name, ...) #func_name,
+#define MPI_SENDRECV(func_name, ...) #func_name,
+#define MPI_TYPE_FREE(func_name, ...) #func_name,
+#define MPI_WIN_CREATE(func_name, ...) #func_name,
+#define MPI_WIN_FREE(func_name, ...) #func_name,
+#define MPI_RMA_OP(func_name, ...) #func_name,
+#define MPI_RMA_REQUEST(func_name, ...) #func_name,
+#define MPI_RMA_EPOCH(func_name, ...) #func_name,
+#define MPI_FILE_OPEN(func_name, ...) #func_name,
+#define MPI_FILE_CLOSE(func_name, ...) #func_name,
+#define MPI_FILE_CALL(func_name, ...) #func_name,
+#define MPI_FILE_IO(func_name, ...) #func_name,
+#define MPI_FILE_IO_REQUEST(func_name, ...) #func_name,
+#include "mpi_functions.def"
+#undef MPI_FUNCTION
+#undef MPI_COMM_CREATE
+#undef MPI_COMM_FREE
+#undef MPI_REQUEST_POST
+#undef MPI_REQUEST_INIT
+#undef MPI_WITH_STATUS
+#undef MPI_PROBE_POLL
+#undef MPI_MATCHED_PROBE
+#undef MPI_MATCHED_PROBE_POLL
+#undef MPI_SENDRECV
+#undef MPI_TYPE_FREE
+#undef MPI_WIN_CREATE
+#undef MPI_WIN_FREE
+#undef MPI_RMA_OP
+#undef MPI_RMA_REQUEST
+#undef MPI_RMA_EPOCH
+#undef MPI_FILE_OPEN
+#undef MPI_FILE_CLOSE
+#undef MPI_FILE_CALL
+#undef MPI_FILE_IO
+#undef MPI_FILE_IO_REQUEST
+    "Init",
+    "Finalize",
+    "Pcontrol",
+    "Start",
+    "Startall",
+    "Wait",
+    "Waitall",
+    "Waitany",
+    "Waitsome",
+    "Test",
+    "Testall",
+    "Testany",
+    "Testsome",
+    "Request_free",
+    "Win_test",
+};
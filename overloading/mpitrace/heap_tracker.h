@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Счётчики динамической памяти процесса (MPITRACE_HEAP=1, libmpitrace_heap.so).
+// Каждый поток пишет в свою строку без блокировок; занятая память ранга -
+// сумма строк, так как блок может быть освобождён другим потоком.
+// Размер блока берётся malloc_usable_size при выделении и при освобождении,
+// поэтому заголовки к блокам не добавляются.
+//
+// Объект инициализируется константами: malloc вызывается ещё до
+// конструкторов глобальных объектов библиотеки.
+class HeapCounters {
+public:
+    // Показания ранга для события COUNTER
+    struct Sample {
+        uint64_t live;
+        uint64_t peak;
+        uint64_t allocations;  // с предыдущего показания
+    };
+
+private:
+    struct alignas(64) Row {
+        std::atomic<int64_t> live{0};
+        std::atomic<uint64_t> allocations{0};
+        std::atomic<uint64_t> frees{0};
+    };
+
+    // Строка потока меняется без атомарных операций чтения-записи; потоки
+    // сверх MAX_ROWS - 1 делят последнюю строку через fetch_add
+    static constexpr uint32_t MAX_ROWS = 256;
+    Row _rows[MAX_ROWS];
+    std::atomic<uint32_t> _used{0};
+    std::atomic<uint64_t> _peak{0};
+    std::atomic<uint64_t> _sampled_allocations{0};
+    std::atomic<uint64_t> _sampled_changes{0};
+    bool _enabled = false;
+    uint64_t _large = 1 << 20;
+    uint32_t _interval_ms = 10;
+
+    // initial-exec: обращение к TLS не должно само выделять память
+    __attribute__((tls_model("initial-exec"))) inline static thread_local Row* _row = nullptr;
+
+    Row& row() {
+        if (!_row) _row = &_rows[std::min(_used.fetch_add(1, std::memory_order_relaxed), MAX_ROWS - 1)];
+        return *_row;
+    }
+
+    template <class T, class D>
+    void add(std::atomic<T>& counter, D delta, const Row& own) {
+        if (&own == &_rows[MAX_ROWS - 1]) {
+            counter.fetch_add(static_cast<T>(delta), std::memory_order_relaxed);
+        } else {
+            counter.store(counter.load(std::memory_order_relaxed) + static_cast<T>(delta), std::memory_order_relaxed);
+        }
+    }
+
+    static void raise(std::atomic<uint64_t>& value, uint64_t candidate) {
+        uint64_t current = value.load(std::memory_order_relaxed);
+        while (current < candidate && !value.compare_exchange_weak(current, candidate, std::memory_order_relaxed)) {
+        }
+    }
+
+public:
+    // Порог MPITRACE_HEAP_LARGE (байты): крупные выделения пишутся событиями
+    // HEAP; MPITRACE_HEAP_INTERVAL_MS - период показаний между вызовами MPI.
+    // getenv не выделяет память, поэтому вызывается из первого malloc.
+    void init() {
+        const char* enabled = std::getenv("MPITRACE_HEAP");
+        _enabled = enabled && std::atoi(enabled) != 0;
+        if (const char* value = std::getenv("MPITRACE_HEAP_LARGE")) _large = std::strtoull(value, nullptr, 10);
+        if (const char* value = std::getenv("MPITRACE_HEAP_INTERVAL_MS")) _interval_ms = std::atoi(value);
+    }
+
+    bool enabled() const {
+        return _enabled;
+    }
+
+    std::chrono::milliseconds interval() const {
+        return std::chrono::milliseconds(_interval_ms);
+    }
+
+    bool large(size_t size) const {
+        return size >= _large;
+    }
+
+    void allocated(size_t size) {
+        Row& own = row();
+        add(own.live, size, own);
+        add(own.allocations, 1, own);
+    }
+
+    void freed(size_t size) {
+        Row& own = row();
+        add(own.live, -static_cast<int64_t>(size), own);
+        add(own.frees, 1, own);
+    }
+
+    // false - с предыдущего показания (любого потока) ничего не изменилось.
+    // Максимум ранга обновляется по показаниям: пик между ними не виден.
+    bool sample(Sample& out) {
+        int64_t live = 0;
+        uint64_t allocations = 0, frees = 0;
+        uint32_t used = std::min(_used.load(std::memory_order_relaxed), MAX_ROWS);
+        for (uint32_t i = 0; i < used; i++) {
+            live += _rows[i].live.load(std::memory_order_relaxed);
+            allocations += _rows[i].allocations.load(std::memory_order_relaxed);
+            frees += _rows[i].frees.load(std::memory_order_relaxed);
+        }
+        if (_sampled_changes.exchange(allocations + frees, std::memory_order_relaxed) == allocations + frees) return false;
+        out.live = live > 0 ? static_cast<uint64_t>(live) : 0;
+        raise(_peak, out.live);
+        out.peak = _peak.load(std::memory_order_relaxed);
+        uint64_t previous = _sampled_allocations.exchange(allocations, std::memory_order_relaxed);
+        out.allocations = allocations > previous ? allocations - previous : 0;
+        return true;
+    }
+};
+
+// Настоящие функции распределителя (libc или подгруженный раньше, например jemalloc)
+struct HeapFunctions {
+    void* (*malloc)(size_t) = nullptr;
+    void* (*calloc)(size_t, size_t) = nullptr;
+    void* (*realloc)(void*, size_t) = nullptr;
+    void (*free)(void*) = nullptr;
+    int (*posix_memalign)(void**, size_t, size_t) = nullptr;
+    void* (*aligned_alloc)(size_t, size_t) = nullptr;
+    void* (*memalign)(size_t, size_t) = nullptr;
+    void* (*valloc)(size_t) = nullptr;
+    void* (*pvalloc)(size_t) = nullptr;
+    size_t (*usable_size)(void*) = nullptr;
+};
+
+// dlsym сам вызывает calloc, поэтому выделения на время поиска настоящих
+// функций берутся из статического буфера и никогда не освобождаются
+class BootstrapHeap {
+private:
+    alignas(16) inline static char _buffer[16384];
+    inline static std::atomic<size_t> _used{0};
+
+public:
+    static void* allocate(size_t size) {
+        size = (size + 15) & ~size_t(15);
+        size_t offset = _used.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size > sizeof(_buffer)) return nullptr;
+        return _buffer + offset;  // статический буфер уже заполнен нулями (calloc)
+    }
+
+    // Размер блока неизвестен: realloc копирует не дальше конца буфера
+    static size_t available(const void* pointer) {
+        return _buffer + sizeof(_buffer) - static_cast<const char*>(pointer);
+    }
+
+    static bool owns(const void* pointer) {
+        return pointer >= _buffer && pointer < _buffer + sizeof(_buffer);
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <mpi.h>
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <unordered_set>
+
+// Идентификаторы коммуникаторов, окон и файлов: максимум счётчиков всех
+// участников (Allreduce MAX), поэтому у двух объектов с общим процессом они
+// различны. Потоки одного процесса (MPI_THREAD_MULTIPLE) согласуют
+// одновременно на разных коммуникаторах, и максимум одного согласования
+// может совпасть с результатом другого. Поэтому кандидат резервируется до
+// Allreduce, результат занимается в процессе, и если хоть у одного
+// участника он уже занят, согласование повторяется выше него.
+// Блокировка не держится во время Allreduce: в нём ждут другие процессы.
+class IdAgreement {
+private:
+    uint32_t _next = 0;
+    std::unordered_set<uint32_t> _taken;  // кандидаты и результаты идущих согласований
+    uint32_t _active = 0;
+    std::mutex _mutex;
+
+    uint32_t reserve(uint32_t lowest) {
+        uint32_t candidate = std::max(_next, lowest);
+        _next = candidate + 1;
+        _taken.insert(candidate);
+        return candidate;
+    }
+
+    // Результат свой, если это собственный кандидат или он ещё не занят
+    bool claim(uint32_t candidate, uint32_t id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return id == candidate || _taken.insert(id).second;
+    }
+
+    uint32_t retry(uint32_t candidate, uint32_t id, bool claimed) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (claimed && id != candidate) _taken.erase(id);
+        _taken.erase(candidate);
+        return reserve(id + 1);
+    }
+
+    // Результат уже не может совпасть: новые кандидаты выше него. Занятые
+    // числа нужны, только пока идут другие согласования
+    void finish(uint32_t id) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _next = std::max(_next, id + 1);
+        if (--_active == 0) _taken.clear();
+    }
+
+public:
+    // Первый свободный идентификатор (до согласований)
+    void reset(uint32_t next) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _next = next;
+    }
+
+    // Коллективная операция над comm (интракоммуникатор)
+    uint32_t agree(MPI_Comm comm) {
+        uint32_t candidate;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _active++;
+            candidate = reserve(0);
+        }
+        while (true) {
+            uint32_t id;
+            PMPI_Allreduce(&candidate, &id, 1, MPI_UINT32_T, MPI_MAX, comm);
+            int conflict = !claim(candidate, id);
+            int any_conflict;
+            PMPI_Allreduce(&conflict, &any_conflict, 1, MPI_INT, MPI_MAX, comm);
+            if (!any_conflict) {
+                finish(id);
+                return id;
+            }
+            candidate = retry(candidate, id, !conflict);
+        }
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Последний найденный в реестре дескриптор, свой у каждого потока:
+// обращения подряд обычно идут к одному коммуникатору или типу, и попадание
+// обходится без блокировок. Удаление из реестра увеличивает поколение,
+// после чего запомненные значения всех потоков считаются устаревшими.
+// Owner отделяет кэши реестров с одинаковыми типами дескрипторов (MPICH: int).
+template <class Owner, class Handle, class Value>
+class LastHit {
+private:
+    struct Entry {
+        Handle handle{};
+        Value value{};
+        uint64_t generation = 0;
+    };
+
+    inline static thread_local Entry _entry{};
+    std::atomic<uint64_t> _generation{1};
+
+public:
+    // Поколение читается до поиска в таблице: удаление во время поиска
+    // сделает запомненное значение устаревшим
+    uint64_t generation() const {
+        return _generation.load(std::memory_order_acquire);
+    }
+
+    bool find(Handle handle, Value& value) const {
+        if (_entry.generation != generation() || _entry.handle != handle) return false;
+        value = _entry.value;
+        return true;
+    }
+
+    void remember(Handle handle, Value value, uint64_t generation) {
+        _entry = Entry{handle, value, generation};
+    }
+
+    void invalidate() {
+        _generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+};
@@ -1,17 +1,18 @@
-﻿#include "new_mpi.h"
+#include <mpi.h>
 #include <iostream>
 #include <random>
+#include "pt_region.h"
 
 
-
-int main(int* argc, char*** argv){
-    MPI_Init(argc, argv);
+int main(int argc, char** argv){
+    MPI_Init(&argc, &argv);
     int size, rank;
     MPI_Comm_size(MPI_COMM_WORLD, &size);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     int size_a = 5;
     int* a = new int[size_a];
     if (rank == 0){
+        PT_SCOPE("fill");
         for (int i = 0; i < size_a; i++){
             a[i] = rand() % size;
         }
@@ -19,10 +20,12 @@ int main(int* argc, char*** argv){
     }
     if (rank == 1){
         MPI_Recv(a, size_a, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        PT_REGION_BEGIN("print");
         for (int i = 0; i < size_a; i++){
             std::cout << a[i] << " ";
         }
         std::cout << "\n";
+        PT_REGION_END("print");
     }
     MPI_Bcast(&size_a, 1, MPI_INT, 0, MPI_COMM_WORLD);
     int result;
@@ -30,6 +33,8 @@ int main(int* argc, char*** argv){
     if (rank == 0) {
         std::cout << result << "\n";
     }
+
+    delete[] a;
     MPI_Finalize();
     return 0;
 }
@@ -0,0 +1,1200 @@
+#include <mpi.h>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <atomic>
+#include <cstring>
+#include <cstdarg>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trace_collector.h"
+#include "comm_registry.h"
+#include "file_registry.h"
+#include "function_table.h"
+#include "heap_tracker.h"
+#include "periodic_thread.h"
+#ifdef MPITRACE_OMPT
+#include "ompt_tool.h"
+#endif
+#include "posix_io.h"
+#include "stack_sampler.h"
+#include "request_table.h"
+#include "type_cache.h"
+#include "win_registry.h"
+
+// Экспортируемые обёртки MPI_* перехватывают вызовы приложения
+// (через LD_PRELOAD или -lmpitrace) и передают их в PMPI_*.
+#define MPITRACE_EXPORT extern "C" __attribute__((visibility("default")))
+
+static TraceCollector<DefaultClock> global_collector;
+using RecordingScope = TraceCollector<DefaultClock>::RecordingScope;
+static CommRegistry comm_registry;
+static RequestTable request_table;
+static MessageTable message_table;
+static TypeSizeCache type_sizes;
+static WinRegistry win_registry;
+static FileRegistry file_registry;
+static FunctionFilter function_filter;
+static PosixFiles posix_files;
+static HeapCounters heap_counters;
+static HeapFunctions heap_functions;
+static PeriodicThread heap_sampler;
+static StackSampler<DefaultClock> stack_sampler;
+static PeriodicThread stack_drainer;
+static std::vector<StackSample> stack_samples;  // разобранные кольца до передачи в трассу
+// Функции пишутся между MPI_Init и MPI_Finalize: деструкторы глобальных
+// объектов приложения вызывают хуки уже после разрушения объектов выше
+static std::atomic<bool> functions_enabled{false};
+// То же для событий памяти; счётчики ведутся с первого malloc
+static std::atomic<bool> heap_events_enabled{false};
+// События OpenMP (OMPT): рабочие потоки среды живут до её завершения
+static std::atomic<bool> openmp_enabled{false};
+
+// Направление передачи данных: по нему заполняются peer (у коллектива с корнем - корень) и номер коллектива
+enum class CallKind {
+    NONE,        // без явных получателей (Wait, Comm_rank, ...)
+    SEND,        // peer - получатель
+    RECV,        // peer - отправитель
+    ONE_TO_ALL,  // root рассылает всем (Bcast, Scatter)
+    ALL_TO_ONE,  // все отправляют root'у (Gather, Reduce)
+    ALL_TO_ALL,  // каждый с каждым (Allreduce, Alltoall, ...)
+    SYNC,        // коллектив без данных (Barrier, Comm_split, Win_fence, ...)
+    NEIGHBOR,    // обмен с соседями по топологии (Neighbor_*)
+};
+
+// Коллективы нумеруются на коммуникаторе (файла и окна - на них самих):
+// все участники вызывают их в одном порядке
+static inline bool is_collective(CallKind kind) {
+    return kind == CallKind::ONE_TO_ALL || kind == CallKind::ALL_TO_ONE || kind == CallKind::ALL_TO_ALL ||
+           kind == CallKind::SYNC || kind == CallKind::NEIGHBOR;
+}
+
+// Аргументы вызова, извлечённые по таблице mpi_functions.def
+struct CallArgs {
+    int peer;
+    int count;
+    MPI_Datatype datatype;
+    MPI_Comm comm;
+    int root;
+    int tag;
+    MPI_Status* status = nullptr;  // только для MPI_WITH_STATUS
+};
+
+// Объём данных вызова; для векторных вариантов (count-массивы) - 0
+static inline uint64_t message_bytes(const CallArgs& args) {
+    if (args.count <= 0) return 0;
+    return static_cast<uint64_t>(args.count) * type_sizes.size(args.datatype);
+}
+
+// Ранги переводятся в MPI_COMM_WORLD, чтобы события на
+// разбитых коммуникаторах попадали в строки нужных процессов
+static inline void fill_event(EventRecord& event, CallKind kind, const CallArgs& args) {
+    event.bytes = message_bytes(args);
+    if (args.comm == MPI_COMM_NULL) {
+        if (kind == CallKind::SEND || kind == CallKind::RECV) {
+            event.peer = args.peer >= 0 ? args.peer : -1;
+            event.tag = args.tag;
+        }
+        return;
+    }
+    CommInfo& info = comm_registry.get(args.comm);
+    event.comm = info.id;
+    if (is_collective(kind)) {
+        event.flags |= INSTANCE;
+        event.link = info.collectives++;
+    }
+
+    switch (kind) {
+    case CallKind::SEND:
+    case CallKind::RECV:
+        if (args.peer >= 0) event.peer = info.peer_to_world(args.peer);
+        event.tag = args.tag;
+        break;
+    case CallKind::ONE_TO_ALL:
+    case CallKind::ALL_TO_ONE:
+        // Участники не копируются в событие: состав коммуникатора пишется
+        // один раз (секция COMMS), у коллектива с корнем в событии только корень.
+        // root вне [0, size) - интеркоммуникатор (MPI_ROOT / MPI_PROC_NULL)
+        if (args.root >= 0) event.peer = info.peer_to_world(args.root);
+        break;
+    case CallKind::ALL_TO_ALL:
+    case CallKind::SYNC:
+    case CallKind::NEIGHBOR:
+    case CallKind::NONE:
+        break;
+    }
+}
+
+// Источник и тег из статуса (MPI_ANY_SOURCE, MPI_ANY_TAG в аргументах);
+// для приёма - фактический объём вместо размера буфера
+static inline void resolve_status(EventRecord& event, CallKind kind, const CallArgs& args) {
+    const MPI_Status& status = *args.status;
+    if (status.MPI_SOURCE < 0) return;  // MPI_PROC_NULL или Iprobe без сообщения
+    event.peer = args.comm != MPI_COMM_NULL ? comm_registry.get(args.comm).peer_to_world(status.MPI_SOURCE) : status.MPI_SOURCE;
+    event.tag = status.MPI_TAG;
+    if (kind == CallKind::RECV && args.datatype != MPI_DATATYPE_NULL) {
+        int count = 0;
+        PMPI_Get_count(&status, args.datatype, &count);
+        if (count != MPI_UNDEFINED) event.bytes = static_cast<uint64_t>(count) * type_sizes.size(args.datatype);
+    }
+}
+
+// Ключ ряда опросов: 0 - вызов пишется обычным событием
+constexpr uint64_t NO_POLL = 0;
+
+// Поток внутри вызова MPI: open/read/write самой библиотеки MPI (MPI-IO)
+// не пишутся событиями POSIX, иначе объём MPI-IO учитывался бы дважды
+__attribute__((tls_model("initial-exec"))) static thread_local bool inside_mpi = false;
+
+struct MpiCallScope {
+    bool saved;
+    MpiCallScope() : saved(inside_mpi) {
+        inside_mpi = true;
+    }
+    ~MpiCallScope() {
+        inside_mpi = saved;
+    }
+};
+
+// before/after выполняются вне замера времени вызова.
+// poll_key вычисляется после вызова: ненулевой ключ означает неудачный
+// опрос, который сливается с предыдущими (TraceCollector::push_poll).
+#define TRACE_MPI_CALL_POLLED(func_name, kind, call_args, args, before, poll_key, after) \
+    do { \
+        if (!global_collector.recording()) return PMPI_##func_name args; \
+        MpiCallScope mpi_scope; \
+        static const uint16_t event_name = global_collector.intern(#func_name); \
+        const CallArgs trace_args = call_args; \
+        EventRecord event = global_collector.make_event(event_name); \
+        const bool profiling = global_collector.profiling(); \
+        if (!profiling) fill_event(event, kind, trace_args); \
+        before; \
+        event.start = global_collector.now(); \
+        int trace_result = PMPI_##func_name args; \
+        event.end = global_collector.now(); \
+        [[maybe_unused]] uint32_t event_index = NO_LINK; \
+        if (profiling) { \
+            global_collector.record(FUNCTION_##func_name, event.start, event.end, message_bytes(trace_args)); \
+        } else if (uint64_t poll = trace_result == MPI_SUCCESS ? uint64_t(poll_key) : NO_POLL) { \
+            global_collector.push_poll(event, poll, global_collector.context(__builtin_frame_address(0))); \
+        } else { \
+            if (trace_args.status && trace_result == MPI_SUCCESS) resolve_status(event, kind, trace_args); \
+            event_index = global_collector.push_back(event, global_collector.context(__builtin_frame_address(0))); \
+            if (heap_counters.enabled()) sample_heap(); \
+        } \
+        if (trace_result == MPI_SUCCESS) { after; } \
+        return trace_result; \
+    } while(0)
+
+#define TRACE_MPI_CALL_HOOKED(func_name, kind, call_args, args, before, after) \
+    TRACE_MPI_CALL_POLLED(func_name, kind, call_args, args, before, NO_POLL, after)
+
+#define TRACE_MPI_CALL(func_name, kind, call_args, args) \
+    TRACE_MPI_CALL_HOOKED(func_name, kind, call_args, args, , )
+
+#define NO_CALL_ARGS (CallArgs{MPI_PROC_NULL, 0, MPI_DATATYPE_NULL, MPI_COMM_NULL, MPI_PROC_NULL, MPI_ANY_TAG})
+
+
+/* Динамическая память (heap_tracker.h, MPITRACE_HEAP=1) */
+
+// Счётчики и события заполняют только обёртки malloc и др., которые есть
+// лишь в libmpitrace_heap.so (MPITRACE_HEAP_HOOKS): libmpitrace.so не
+// перехватывает выделения памяти вовсе. Без них heap_counters выключены.
+
+// Выделения во время записи события памяти только считаются
+__attribute__((tls_model("initial-exec"))) static thread_local bool heap_inside = false;
+
+static bool heap_recording() {
+    return !heap_inside && !global_collector.allocating() && heap_events_enabled.load(std::memory_order_acquire);
+}
+
+// Показание пишется, только если счётчики изменились
+static void sample_heap() {
+    if (!heap_recording()) return;
+    RecordingScope scope(global_collector);
+    if (!scope) return;
+    heap_inside = true;
+    HeapCounters::Sample sample;
+    if (heap_counters.sample(sample)) {
+        static const uint16_t event_name = global_collector.intern("heap");
+        EventRecord event = global_collector.make_event(event_name);
+        event.flags = COUNTER;
+        event.start = event.end = global_collector.now();
+        event.bytes = sample.live;
+        event.offset = sample.peak;
+        event.data = static_cast<uint32_t>(std::min<uint64_t>(sample.allocations, UINT32_MAX));
+        global_collector.push_back(event);
+    }
+    heap_inside = false;
+}
+
+#ifdef MPITRACE_HEAP_HOOKS
+// Настоящие функции ищутся при первом вызове; вложенные вызовы из dlsym
+// получают false и берут память из BootstrapHeap
+enum HeapState { HEAP_UNRESOLVED, HEAP_RESOLVING, HEAP_READY };
+static std::atomic<int> heap_state{HEAP_UNRESOLVED};
+__attribute__((tls_model("initial-exec"))) static thread_local bool heap_resolving = false;
+
+static bool heap_ready() {
+    if (heap_state.load(std::memory_order_acquire) == HEAP_READY) return true;
+    if (heap_resolving) return false;
+    int expected = HEAP_UNRESOLVED;
+    if (!heap_state.compare_exchange_strong(expected, HEAP_RESOLVING)) {
+        while (heap_state.load(std::memory_order_acquire) != HEAP_READY) {
+        }
+        return true;
+    }
+    heap_resolving = true;
+    HeapFunctions functions;
+    functions.malloc = next_function<decltype(functions.malloc)>("malloc");
+    functions.calloc = next_function<decltype(functions.calloc)>("calloc");
+    functions.realloc = next_function<decltype(functions.realloc)>("realloc");
+    functions.free = next_function<decltype(functions.free)>("free");
+    functions.posix_memalign = next_function<decltype(functions.posix_memalign)>("posix_memalign");
+    functions.aligned_alloc = next_function<decltype(functions.aligned_alloc)>("aligned_alloc");
+    functions.memalign = next_function<decltype(functions.memalign)>("memalign");
+    functions.valloc = next_function<decltype(functions.valloc)>("valloc");
+    functions.pvalloc = next_function<decltype(functions.pvalloc)>("pvalloc");
+    functions.usable_size = next_function<decltype(functions.usable_size)>("malloc_usable_size");
+    heap_functions = functions;
+    heap_counters.init();
+    heap_resolving = false;
+    heap_state.store(HEAP_READY, std::memory_order_release);
+    return true;
+}
+
+#endif
+
+// Имена событий выделения интернируются при старте записи, а не static
+// в обёртках: intern сам выделяет память и вошёл бы в ту же обёртку
+struct HeapNames {
+    uint16_t malloc = 0;
+    uint16_t calloc = 0;
+    uint16_t realloc = 0;
+    uint16_t posix_memalign = 0;
+    uint16_t aligned_alloc = 0;
+    uint16_t memalign = 0;
+    uint16_t valloc = 0;
+    uint16_t pvalloc = 0;
+
+    void init() {
+        malloc = global_collector.intern("malloc");
+        calloc = global_collector.intern("calloc");
+        realloc = global_collector.intern("realloc");
+        posix_memalign = global_collector.intern("posix_memalign");
+        aligned_alloc = global_collector.intern("aligned_alloc");
+        memalign = global_collector.intern("memalign");
+        valloc = global_collector.intern("valloc");
+        pvalloc = global_collector.intern("pvalloc");
+    }
+};
+static HeapNames heap_names;
+
+#ifdef MPITRACE_HEAP_HOOKS
+
+// Крупное выделение пишется событием HEAP с длительностью вызова
+// и сразу показанием: максимум ранга обычно растёт на нём
+template <typename Call>
+static void* trace_allocation(uint16_t event_name, size_t size, Call call) {
+    void* block;
+    if (heap_counters.large(size) && heap_recording()) {
+        RecordingScope scope(global_collector);
+        if (scope) {
+            uint64_t start = global_collector.now();
+            block = call();
+            uint64_t end = global_collector.now();
+            heap_inside = true;
+            EventRecord event = global_collector.make_event(event_name);
+            event.flags = HEAP;
+            event.start = start;
+            event.end = end;
+            event.bytes = size;
+            event.offset = reinterpret_cast<uintptr_t>(block);
+            if (block) heap_counters.allocated(heap_functions.usable_size(block));
+            global_collector.push_back(event);
+            heap_inside = false;
+            sample_heap();
+            return block;
+        }
+    }
+    block = call();
+    if (block) heap_counters.allocated(heap_functions.usable_size(block));
+    return block;
+}
+
+MPITRACE_EXPORT void* malloc(size_t size) noexcept {
+    if (!heap_ready()) return BootstrapHeap::allocate(size);
+    if (!heap_counters.enabled()) return heap_functions.malloc(size);
+    return trace_allocation(heap_names.malloc, size, [&] { return heap_functions.malloc(size); });
+}
+
+MPITRACE_EXPORT void* calloc(size_t count, size_t size) noexcept {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) total = SIZE_MAX;
+    if (!heap_ready()) return BootstrapHeap::allocate(total);
+    if (!heap_counters.enabled()) return heap_functions.calloc(count, size);
+    return trace_allocation(heap_names.calloc, total, [&] { return heap_functions.calloc(count, size); });
+}
+
+MPITRACE_EXPORT void free(void* block) noexcept {
+    if (!block || BootstrapHeap::owns(block) || !heap_ready()) return;
+    if (heap_counters.enabled()) heap_counters.freed(heap_functions.usable_size(block));
+    heap_functions.free(block);
+}
+
+// realloc(p, 0) освобождает блок и возвращает nullptr
+MPITRACE_EXPORT void* realloc(void* block, size_t size) noexcept {
+    if (BootstrapHeap::owns(block) || !heap_ready()) {
+        void* moved = malloc(size);
+        if (moved && block) std::memcpy(moved, block, std::min(size, BootstrapHeap::available(block)));
+        return moved;
+    }
+    if (!heap_counters.enabled()) return heap_functions.realloc(block, size);
+    size_t old_size = block ? heap_functions.usable_size(block) : 0;
+    void* moved = trace_allocation(heap_names.realloc, size, [&] { return heap_functions.realloc(block, size); });
+    if (block && (moved || !size)) heap_counters.freed(old_size);
+    return moved;
+}
+
+MPITRACE_EXPORT int posix_memalign(void** block, size_t alignment, size_t size) noexcept {
+    if (!heap_ready()) return ENOMEM;
+    if (!heap_counters.enabled()) return heap_functions.posix_memalign(block, alignment, size);
+    int result = 0;
+    trace_allocation(heap_names.posix_memalign, size, [&]() -> void* {
+        result = heap_functions.posix_memalign(block, alignment, size);
+        return result == 0 ? *block : nullptr;
+    });
+    return result;
+}
+
+MPITRACE_EXPORT void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    if (!heap_ready()) return nullptr;
+    if (!heap_counters.enabled()) return heap_functions.aligned_alloc(alignment, size);
+    return trace_allocation(heap_names.aligned_alloc, size, [&] { return heap_functions.aligned_alloc(alignment, size); });
+}
+
+MPITRACE_EXPORT void* memalign(size_t alignment, size_t size) noexcept {
+    if (!heap_ready()) return nullptr;
+    if (!heap_counters.enabled()) return heap_functions.memalign(alignment, size);
+    return trace_allocation(heap_names.memalign, size, [&] { return heap_functions.memalign(alignment, size); });
+}
+
+MPITRACE_EXPORT void* valloc(size_t size) noexcept {
+    if (!heap_ready()) return nullptr;
+    if (!heap_counters.enabled()) return heap_functions.valloc(size);
+    return trace_allocation(heap_names.valloc, size, [&] { return heap_functions.valloc(size); });
+}
+
+MPITRACE_EXPORT void* pvalloc(size_t size) noexcept {
+    if (!heap_ready()) return nullptr;
+    if (!heap_counters.enabled()) return heap_functions.pvalloc(size);
+    return trace_allocation(heap_names.pvalloc, size, [&] { return heap_functions.pvalloc(size); });
+}
+#endif
+
+
+/* Инициализация и завершение */
+
+// Снимки стека (stack_sampler.h): таймер заводится в каждом потоке трассы
+static void sample_thread(uint32_t thread) {
+    stack_sampler.add_thread(thread);
+}
+
+static void start_tracing(std::chrono::steady_clock::time_point chrono_start) {
+    auto init_duration = std::chrono::steady_clock::now() - chrono_start;
+
+    int rank;
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    global_collector.set_thread_hook(&sample_thread);
+    global_collector.start(rank, init_duration);
+    if (stack_sampler.init() && !global_collector.profiling()) {
+        stack_sampler.start();
+        stack_sampler.add_thread(0);  // поток MPI_Init зарегистрирован в start()
+        stack_drainer.start(std::chrono::milliseconds(50), [] {
+            stack_sampler.drain(stack_samples);
+            global_collector.write_samples(stack_samples);
+        });
+    }
+    function_filter.init(global_collector.modules());
+    posix_files.init();
+    if (heap_counters.enabled() && !global_collector.profiling()) {
+        heap_names.init();
+        heap_events_enabled.store(true, std::memory_order_release);
+        heap_sampler.start(heap_counters.interval(), [] { sample_heap(); });
+    }
+#ifndef MPITRACE_HEAP_HOOKS
+    if (rank == 0 && std::getenv("MPITRACE_HEAP")) {
+        std::cerr << "mpitrace: MPITRACE_HEAP is ignored, heap tracing needs libmpitrace_heap.so\n";
+    }
+#endif
+    functions_enabled.store(true, std::memory_order_release);
+    if (!global_collector.profiling()) openmp_enabled.store(true, std::memory_order_release);
+    comm_registry.init();
+    if (!global_collector.profiling()) request_table.init();
+}
+
+MPITRACE_EXPORT int MPI_Init(int *argc, char ***argv) {
+    auto chrono_start = std::chrono::steady_clock::now();
+    int result = PMPI_Init(argc, argv);
+    start_tracing(chrono_start);
+    return result;
+}
+
+MPITRACE_EXPORT int MPI_Init_thread(int *argc, char ***argv, int required, int *provided) {
+    auto chrono_start = std::chrono::steady_clock::now();
+    int result = PMPI_Init_thread(argc, argv, required, provided);
+    start_tracing(chrono_start);
+    return result;
+}
+
+static void finish_tracing() {
+    functions_enabled.store(false, std::memory_order_relaxed);
+    openmp_enabled.store(false, std::memory_order_relaxed);
+    heap_sampler.stop();
+    heap_events_enabled.store(false, std::memory_order_relaxed);
+    stack_drainer.stop();
+    stack_sampler.stop();
+    stack_sampler.drain(stack_samples);
+    global_collector.close(comm_registry.definitions(), stack_samples);
+    if (uint64_t dropped = request_table.dropped()) {
+        std::cerr << "mpitrace: " << dropped << " requests were not tracked (request table is full)\n";
+    }
+    if (uint64_t dropped = global_collector.names_dropped()) {
+        std::cerr << "mpitrace: " << dropped << " names did not fit into the string table\n";
+    }
+    if (uint64_t dropped = stack_sampler.dropped()) {
+        std::cerr << "mpitrace: " << dropped << " stack samples were lost (sample ring is full)\n";
+    }
+}
+
+// Коллективные сводки собираются до PMPI_Finalize, пока MPI доступен
+static void prepare_finalize() {
+    global_collector.finish();
+    file_registry.write_summary(global_collector.folder() + "/io_summary", global_collector.ns_per_tick(), MPI_COMM_WORLD);
+}
+
+// Трасса дописывается сразу после PMPI_Finalize, а не в деструкторе
+MPITRACE_EXPORT int MPI_Finalize(void) {
+    TRACE_MPI_CALL_HOOKED(Finalize, CallKind::NONE, NO_CALL_ARGS, (),
+        prepare_finalize(), finish_tracing());
+}
+
+MPITRACE_EXPORT int MPI_Pcontrol(const int level, ...) {
+    TRACE_MPI_CALL(Pcontrol, CallKind::NONE, NO_CALL_ARGS, (level));
+}
+
+
+/* Пользовательские регионы (pt_region.h) */
+
+// Один раз на место вызова; номер региона - номер имени в таблице строк
+// Имя, не поместившееся в таблицу строк, даёт PT_NO_REGION (UINT32_MAX)
+MPITRACE_EXPORT uint32_t pt_region_register(const char* name) {
+    uint16_t region = global_collector.intern(name ? name : "");
+    return region == StringTable::OVERFLOW_NAME ? UINT32_MAX : region;
+}
+
+MPITRACE_EXPORT void pt_region_enter(uint32_t region) {
+    if (region <= UINT16_MAX) global_collector.enter_region(static_cast<uint16_t>(region));
+}
+
+MPITRACE_EXPORT void pt_region_exit(uint32_t region) {
+    if (region <= UINT16_MAX) global_collector.exit_region(static_cast<uint16_t>(region));
+}
+
+
+/* Функции приложения, собранного с -finstrument-functions */
+
+// Пишется только адрес; функции отбираются FunctionFilter (MPITRACE_FUNCTIONS_*),
+// имена восстанавливает tracedump по секции MODULES
+MPITRACE_EXPORT __attribute__((no_instrument_function))
+void __cyg_profile_func_enter(void* function, void*) {
+    if (!functions_enabled.load(std::memory_order_acquire)) return;
+    uint64_t address = reinterpret_cast<uintptr_t>(function);
+    if (function_filter.accept(address)) global_collector.enter_function(address);
+}
+
+MPITRACE_EXPORT __attribute__((no_instrument_function))
+void __cyg_profile_func_exit(void* function, void*) {
+    if (!functions_enabled.load(std::memory_order_acquire)) return;
+    uint64_t address = reinterpret_cast<uintptr_t>(function);
+    if (function_filter.accept(address)) global_collector.exit_function(address);
+}
+
+
+/* Файловый ввод-вывод POSIX (posix_io.h) */
+
+// data - дескриптор, bytes - переданные байты, offset - смещение pread/pwrite.
+// В режиме profile не пишется: профиль ведётся по функциям MPI.
+// Дескрипторы, открытые внутри вызова MPI, не отслеживаются.
+static inline bool posix_recording() {
+    return !inside_mpi && posix_files.enabled() && global_collector.recording() && !global_collector.profiling();
+}
+
+template <typename Call>
+static inline auto trace_posix(uint16_t event_name, int fd, uint64_t offset, Call call) {
+    RecordingScope scope(global_collector);
+    if (!scope) return call();
+    EventRecord event = global_collector.make_event(event_name);
+    event.flags = POSIX_IO;
+    event.data = static_cast<uint32_t>(fd);
+    event.offset = offset;
+    event.start = global_collector.now();
+    auto result = call();
+    event.end = global_collector.now();
+    global_collector.push_back(event);
+    return result;
+}
+
+// Мелкие передачи одного дескриптора подряд сливаются в ряд POSIX_IO|POLLS
+template <typename Call>
+static inline ssize_t trace_transfer(uint16_t event_name, int fd, uint64_t offset, Call call) {
+    RecordingScope scope(global_collector);
+    if (!scope) return call();
+    EventRecord event = global_collector.make_event(event_name);
+    event.flags = POSIX_IO;
+    event.data = static_cast<uint32_t>(fd);
+    event.offset = offset;
+    event.start = global_collector.now();
+    ssize_t result = call();
+    event.end = global_collector.now();
+    if (result > 0) event.bytes = static_cast<uint64_t>(result);
+    if (posix_files.small(event.bytes)) {
+        global_collector.push_poll(event, static_cast<uint64_t>(fd) + 1);
+    } else {
+        global_collector.push_back(event);
+    }
+    return result;
+}
+
+using OpenFunction = int (*)(const char*, int, ...);
+
+static int open_file(OpenFunction real, const char* path, int flags, mode_t mode) {
+    if (!posix_recording()) return real(path, flags, mode);
+    RecordingScope scope(global_collector);
+    if (!scope) return real(path, flags, mode);
+    static const uint16_t event_name = global_collector.intern("open");
+    EventRecord event = global_collector.make_event(event_name);
+    event.flags = POSIX_IO;
+    event.start = global_collector.now();
+    int fd = real(path, flags, mode);
+    event.end = global_collector.now();
+    event.data = static_cast<uint32_t>(fd);
+    global_collector.push_back(event);
+    posix_files.track(fd);
+    return fd;
+}
+
+// Режим передаётся только с O_CREAT и O_TMPFILE
+static inline mode_t open_mode(int flags, va_list args) {
+    return (flags & O_CREAT) || (flags & O_TMPFILE) == O_TMPFILE ? static_cast<mode_t>(va_arg(args, int)) : 0;
+}
+
+MPITRACE_EXPORT int open(const char* path, int flags, ...) {
+    va_list args;
+    va_start(args, flags);
+    mode_t mode = open_mode(flags, args);
+    va_end(args);
+    static auto real = next_function<OpenFunction>("open");
+    return open_file(real, path, flags, mode);
+}
+
+MPITRACE_EXPORT int open64(const char* path, int flags, ...) {
+    va_list args;
+    va_start(args, flags);
+    mode_t mode = open_mode(flags, args);
+    va_end(args);
+    static auto real = next_function<OpenFunction>("open64");
+    return open_file(real, path, flags, mode);
+}
+
+MPITRACE_EXPORT ssize_t read(int fd, void* buffer, size_t count) {
+    static auto real = next_function<decltype(&::read)>("read");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd, buffer, count);
+    static const uint16_t event_name = global_collector.intern("read");
+    return trace_transfer(event_name, fd, NO_OFFSET, [&] { return real(fd, buffer, count); });
+}
+
+MPITRACE_EXPORT ssize_t write(int fd, const void* buffer, size_t count) {
+    static auto real = next_function<decltype(&::write)>("write");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd, buffer, count);
+    static const uint16_t event_name = global_collector.intern("write");
+    return trace_transfer(event_name, fd, NO_OFFSET, [&] { return real(fd, buffer, count); });
+}
+
+MPITRACE_EXPORT ssize_t pread(int fd, void* buffer, size_t count, off_t offset) {
+    static auto real = next_function<decltype(&::pread)>("pread");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd, buffer, count, offset);
+    static const uint16_t event_name = global_collector.intern("pread");
+    return trace_transfer(event_name, fd, offset, [&] { return real(fd, buffer, count, offset); });
+}
+
+MPITRACE_EXPORT ssize_t pread64(int fd, void* buffer, size_t count, off64_t offset) {
+    static auto real = next_function<decltype(&::pread64)>("pread64");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd, buffer, count, offset);
+    static const uint16_t event_name = global_collector.intern("pread");
+    return trace_transfer(event_name, fd, offset, [&] { return real(fd, buffer, count, offset); });
+}
+
+MPITRACE_EXPORT ssize_t pwrite(int fd, const void* buffer, size_t count, off_t offset) {
+    static auto real = next_function<decltype(&::pwrite)>("pwrite");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd, buffer, count, offset);
+    static const uint16_t event_name = global_collector.intern("pwrite");
+    return trace_transfer(event_name, fd, offset, [&] { return real(fd, buffer, count, offset); });
+}
+
+MPITRACE_EXPORT ssize_t pwrite64(int fd, const void* buffer, size_t count, off64_t offset) {
+    static auto real = next_function<decltype(&::pwrite64)>("pwrite64");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd, buffer, count, offset);
+    static const uint16_t event_name = global_collector.intern("pwrite");
+    return trace_transfer(event_name, fd, offset, [&] { return real(fd, buffer, count, offset); });
+}
+
+MPITRACE_EXPORT int fsync(int fd) {
+    static auto real = next_function<decltype(&::fsync)>("fsync");
+    if (!posix_files.tracked(fd) || !posix_recording()) return real(fd);
+    static const uint16_t event_name = global_collector.intern("fsync");
+    return trace_posix(event_name, fd, NO_OFFSET, [&] { return real(fd); });
+}
+
+// Флаг снимается до закрытия: после него номер может открыть другой поток
+MPITRACE_EXPORT int close(int fd) {
+    static auto real = next_function<decltype(&::close)>("close");
+    if (!posix_files.tracked(fd)) return real(fd);
+    posix_files.untrack(fd);
+    if (!posix_recording()) return real(fd);
+    static const uint16_t event_name = global_collector.intern("close");
+    return trace_posix(event_name, fd, NO_OFFSET, [&] { return real(fd); });
+}
+
+
+#ifdef MPITRACE_OMPT
+/* OpenMP (OMPT, ompt_tool.h) */
+
+// События с флагом OPENMP: data - размер команды (omp_parallel) или число
+// итераций (work), offset - адрес конструкции в программе (codeptr_ra).
+// Ожидания синхронизации пишутся только временем ожидания (sync_region_wait).
+static OmpNames omp_names;
+static thread_local OmpScopes omp_scopes;
+
+static inline bool openmp_recording() {
+    return openmp_enabled.load(std::memory_order_acquire);
+}
+
+static void omp_scope_end(uint32_t kind, uint16_t name, const void* codeptr) {
+    uint64_t end = global_collector.now();
+    OmpScopes::Scope scope;
+    if (!omp_scopes.pop(kind, scope) || !openmp_recording()) return;
+    RecordingScope recording(global_collector);
+    if (!recording) return;
+    EventRecord event = global_collector.make_event(name);
+    event.flags = OPENMP;
+    event.start = scope.start;
+    event.end = end;
+    event.data = static_cast<uint32_t>(std::min<uint64_t>(scope.count, UINT32_MAX));
+    if (codeptr) event.offset = reinterpret_cast<uintptr_t>(codeptr);
+    global_collector.push_back(event);
+}
+
+static void on_parallel_begin(ompt_data_t*, const ompt_frame_t*, ompt_data_t*, unsigned int requested_parallelism,
+                              int, const void*) {
+    omp_scopes.push(OmpScopes::PARALLEL, global_collector.now(), requested_parallelism);
+}
+
+static void on_parallel_end(ompt_data_t*, ompt_data_t*, int, const void* codeptr) {
+    omp_scope_end(OmpScopes::PARALLEL, omp_names.parallel, codeptr);
+}
+
+static void on_work(ompt_work_t kind, ompt_scope_endpoint_t endpoint, ompt_data_t*, ompt_data_t*,
+                    uint64_t count, const void* codeptr) {
+    if (endpoint == ompt_scope_begin) {
+        omp_scopes.push(OmpScopes::WORK | kind, global_collector.now(), count);
+    } else if (endpoint == ompt_scope_end) {
+        omp_scope_end(OmpScopes::WORK | kind, omp_names.work_name(kind), codeptr);
+    }
+}
+
+static void on_sync_region_wait(ompt_sync_region_t kind, ompt_scope_endpoint_t endpoint, ompt_data_t*,
+                                ompt_data_t*, const void* codeptr) {
+    if (endpoint == ompt_scope_begin) {
+        omp_scopes.push(OmpScopes::SYNC | kind, global_collector.now(), 0);
+    } else if (endpoint == ompt_scope_end) {
+        omp_scope_end(OmpScopes::SYNC | kind, omp_names.sync_name(kind), codeptr);
+    }
+}
+
+// Явные задачи помечаются при создании; value хранит начало текущего
+// выполнения задачи (задача может прерываться и продолжаться в другом потоке)
+constexpr uint64_t OMP_TASK_CREATED = 1;
+
+static void on_task_create(ompt_data_t*, const ompt_frame_t*, ompt_data_t* task, int flags, int, const void*) {
+    if (task && (flags & ompt_task_explicit)) task->value = OMP_TASK_CREATED;
+}
+
+static void omp_task_end(uint64_t start, uint64_t end) {
+    RecordingScope recording(global_collector);
+    if (!recording) return;
+    EventRecord event = global_collector.make_event(omp_names.task);
+    event.flags = OPENMP;
+    event.start = start;
+    event.end = end;
+    if (omp_names.each_task) {
+        global_collector.push_back(event);
+    } else {
+        global_collector.push_poll(event, omp_names.task);
+    }
+}
+
+static void on_task_schedule(ompt_data_t* prior, ompt_task_status_t, ompt_data_t* next) {
+    uint64_t now = global_collector.now();
+    if (prior && prior->value > OMP_TASK_CREATED && openmp_recording()) omp_task_end(prior->value, now);
+    if (prior && prior->value) prior->value = OMP_TASK_CREATED;
+    if (next && next->value) next->value = now;
+}
+
+static int ompt_initialize(ompt_function_lookup_t lookup, int, ompt_data_t*) {
+    auto set_callback = reinterpret_cast<ompt_set_callback_t>(lookup("ompt_set_callback"));
+    if (!set_callback) return 0;
+    omp_names.init([](const char* name) { return global_collector.intern(name); });
+    set_callback(ompt_callback_parallel_begin, reinterpret_cast<ompt_callback_t>(&on_parallel_begin));
+    set_callback(ompt_callback_parallel_end, reinterpret_cast<ompt_callback_t>(&on_parallel_end));
+    set_callback(ompt_callback_work, reinterpret_cast<ompt_callback_t>(&on_work));
+    set_callback(ompt_callback_sync_region_wait, reinterpret_cast<ompt_callback_t>(&on_sync_region_wait));
+    set_callback(ompt_callback_task_create, reinterpret_cast<ompt_callback_t>(&on_task_create));
+    set_callback(ompt_callback_task_schedule, reinterpret_cast<ompt_callback_t>(&on_task_schedule));
+    return 1;  // ненулевой результат оставляет инструмент активным
+}
+
+static void ompt_finalize(ompt_data_t*) {}
+
+// Среда OpenMP (libomp и совместимые) ищет эту функцию при старте
+MPITRACE_EXPORT ompt_start_tool_result_t* ompt_start_tool(unsigned int, const char*) {
+    static ompt_start_tool_result_t tool = {&ompt_initialize, &ompt_finalize, {0}};
+    return OmpNames::enabled() ? &tool : nullptr;
+}
+#endif
+
+
+/* Неблокирующие операции: от начала до завершения */
+
+static inline void track_request(MPI_Request request, const EventRecord& post, uint32_t post_index,
+                                 MPI_Comm comm, bool recv, bool persistent) {
+    if (post_index == NO_LINK) return;
+    request_table.insert(request, RequestInfo{post_index, post.name, recv, persistent, !persistent,
+                                              post.peer, post.tag, post.comm, post.bytes, comm});
+}
+
+// Mrecv, Imrecv: коммуникатор сообщения из Mprobe/Improbe; запись снимается
+static inline MPI_Comm matched_comm(MPI_Message message) {
+    return message_table.take(message);
+}
+
+// Приёмная половина Sendrecv: событие завершения в конце вызова со ссылкой
+// на сам вызов; источник, тег и объём - фактические, из статуса
+static void complete_exchange(const EventRecord& call, uint32_t call_index, MPI_Comm comm, MPI_Datatype type,
+                              const MPI_Status& status) {
+    if (call_index == NO_LINK || status.MPI_SOURCE < 0) return;  // MPI_PROC_NULL
+    EventRecord event = global_collector.make_event(call.name);
+    event.flags |= COMPLETION;
+    event.start = event.end = call.end;
+    event.comm = call.comm;
+    event.link = call_index;
+    event.peer = comm_registry.get(comm).peer_to_world(status.MPI_SOURCE);
+    event.tag = status.MPI_TAG;
+    int count = 0;
+    PMPI_Get_count(&status, type, &count);
+    if (count != MPI_UNDEFINED) event.bytes = static_cast<uint64_t>(count) * type_sizes.size(type);
+    global_collector.push_back(event);
+}
+
+static inline void start_request(MPI_Request request, uint32_t start_index) {
+    RequestInfo* info = request_table.find(request);
+    if (!info || start_index == NO_LINK) return;
+    info->post = start_index;
+    info->active = true;
+}
+
+// Событие завершения: нулевой длительности в момент, когда завершение
+// стало известно (конец Wait*/Test*), со ссылкой на событие начала.
+// Для приёма источник и тег - фактические, из MPI_Status.
+// info - копия записи таблицы, снятая до вызова (RequestTable::copy).
+static void complete_request(MPI_Request request, const RequestInfo& info, const MPI_Status& status, uint64_t time) {
+    if (!info.active) return;
+
+    EventRecord event = global_collector.make_event(info.name);
+    event.flags |= COMPLETION;
+    event.start = event.end = time;
+    event.comm = info.comm;
+    event.peer = info.peer;
+    event.tag = info.tag;
+    event.link = info.post;
+    event.bytes = info.bytes;
+    if (info.recv && status.MPI_SOURCE >= 0) {
+        const CommInfo* comm = comm_registry.find(info.handle);
+        event.peer = comm ? comm->peer_to_world(status.MPI_SOURCE) : -1;
+        event.tag = status.MPI_TAG;
+    }
+
+    request_table.release(request, info);
+    global_collector.push_back(event);
+}
+
+// Wait*/Test* обнуляют завершённые запросы, поэтому дескрипторы и записи
+// таблицы копируются до вызова. Статусы нужны всегда: вместо
+// MPI_STATUSES_IGNORE - свой массив.
+struct RequestBatch {
+    MPI_Request* handles;
+    RequestInfo* infos;
+    MPI_Status* statuses;
+
+    RequestBatch(int count, const MPI_Request* requests, MPI_Status* user_statuses) {
+        thread_local std::vector<MPI_Request> handle_storage;
+        thread_local std::vector<RequestInfo> info_storage;
+        thread_local std::vector<MPI_Status> status_storage;
+        handle_storage.assign(requests, requests + count);
+        handles = handle_storage.data();
+        info_storage.resize(count);
+        infos = info_storage.data();
+        for (int i = 0; i < count; i++) request_table.copy(handles[i], infos[i]);
+        if (user_statuses == MPI_STATUSES_IGNORE) {
+            status_storage.resize(count);
+            statuses = status_storage.data();
+        } else {
+            statuses = user_statuses;
+        }
+    }
+};
+
+// Ключи рядов опросов: сам запрос или первый запрос массива
+static inline uint64_t poll_key(MPI_Request request) {
+    uint64_t key = 0;
+    std::memcpy(&key, &request, sizeof(request));
+    return key | 1;
+}
+
+static inline uint64_t poll_key(int count, const MPI_Request* requests) {
+    return count > 0 ? poll_key(requests[0]) ^ (static_cast<uint64_t>(count) << 48) : 1;
+}
+
+MPITRACE_EXPORT int MPI_Start(MPI_Request *request) {
+    TRACE_MPI_CALL_HOOKED(Start, CallKind::NONE, NO_CALL_ARGS, (request),
+        , start_request(*request, event_index));
+}
+
+MPITRACE_EXPORT int MPI_Startall(int count, MPI_Request array_of_requests[]) {
+    TRACE_MPI_CALL_HOOKED(Startall, CallKind::NONE, NO_CALL_ARGS, (count, array_of_requests),
+        , for (int i = 0; i < count; i++) start_request(array_of_requests[i], event_index));
+}
+
+MPITRACE_EXPORT int MPI_Wait(MPI_Request *request, MPI_Status *status) {
+    MPI_Request handle = *request;
+    RequestInfo info;
+    request_table.copy(handle, info);
+    MPI_Status local_status;
+    if (status == MPI_STATUS_IGNORE) status = &local_status;
+    TRACE_MPI_CALL_HOOKED(Wait, CallKind::NONE, NO_CALL_ARGS, (request, status),
+        , complete_request(handle, info, *status, event.end));
+}
+
+MPITRACE_EXPORT int MPI_Waitall(int count, MPI_Request array_of_requests[], MPI_Status array_of_statuses[]) {
+    RequestBatch batch(count, array_of_requests, array_of_statuses);
+    TRACE_MPI_CALL_HOOKED(Waitall, CallKind::NONE, NO_CALL_ARGS, (count, array_of_requests, batch.statuses),
+        , for (int i = 0; i < count; i++) complete_request(batch.handles[i], batch.infos[i], batch.statuses[i], event.end));
+}
+
+MPITRACE_EXPORT int MPI_Waitany(int count, MPI_Request array_of_requests[], int *index, MPI_Status *status) {
+    RequestBatch batch(count, array_of_requests, MPI_STATUSES_IGNORE);
+    MPI_Status local_status;
+    if (status == MPI_STATUS_IGNORE) status = &local_status;
+    TRACE_MPI_CALL_HOOKED(Waitany, CallKind::NONE, NO_CALL_ARGS, (count, array_of_requests, index, status),
+        , if (*index != MPI_UNDEFINED) complete_request(batch.handles[*index], batch.infos[*index], *status, event.end));
+}
+
+MPITRACE_EXPORT int MPI_Waitsome(int incount, MPI_Request array_of_requests[], int *outcount,
+                                 int array_of_indices[], MPI_Status array_of_statuses[]) {
+    RequestBatch batch(incount, array_of_requests, array_of_statuses);
+    TRACE_MPI_CALL_HOOKED(Waitsome, CallKind::NONE, NO_CALL_ARGS,
+        (incount, array_of_requests, outcount, array_of_indices, batch.statuses),
+        , if (*outcount != MPI_UNDEFINED) for (int i = 0; i < *outcount; i++)
+            complete_request(batch.handles[array_of_indices[i]], batch.infos[array_of_indices[i]], batch.statuses[i], event.end));
+}
+
+MPITRACE_EXPORT int MPI_Test(MPI_Request *request, int *flag, MPI_Status *status) {
+    MPI_Request handle = *request;
+    RequestInfo info;
+    request_table.copy(handle, info);
+    MPI_Status local_status;
+    if (status == MPI_STATUS_IGNORE) status = &local_status;
+    TRACE_MPI_CALL_POLLED(Test, CallKind::NONE, NO_CALL_ARGS, (request, flag, status),
+        , *flag ? NO_POLL : poll_key(handle), if (*flag) complete_request(handle, info, *status, event.end));
+}
+
+MPITRACE_EXPORT int MPI_Testall(int count, MPI_Request array_of_requests[], int *flag, MPI_Status array_of_statuses[]) {
+    RequestBatch batch(count, array_of_requests, array_of_statuses);
+    TRACE_MPI_CALL_POLLED(Testall, CallKind::NONE, NO_CALL_ARGS, (count, array_of_requests, flag, batch.statuses),
+        , *flag ? NO_POLL : poll_key(count, batch.handles), if (*flag) for (int i = 0; i < count; i++) complete_request(batch.handles[i], batch.infos[i], batch.statuses[i], event.end));
+}
+
+MPITRACE_EXPORT int MPI_Testany(int count, MPI_Request array_of_requests[], int *index, int *flag, MPI_Status *status) {
+    RequestBatch batch(count, array_of_requests, MPI_STATUSES_IGNORE);
+    MPI_Status local_status;
+    if (status == MPI_STATUS_IGNORE) status = &local_status;
+    TRACE_MPI_CALL_POLLED(Testany, CallKind::NONE, NO_CALL_ARGS, (count, array_of_requests, index, flag, status),
+        , *flag ? NO_POLL : poll_key(count, batch.handles), if (*flag && *index != MPI_UNDEFINED) complete_request(batch.handles[*index], batch.infos[*index], *status, event.end));
+}
+
+MPITRACE_EXPORT int MPI_Testsome(int incount, MPI_Request array_of_requests[], int *outcount,
+                                 int array_of_indices[], MPI_Status array_of_statuses[]) {
+    RequestBatch batch(incount, array_of_requests, array_of_statuses);
+    TRACE_MPI_CALL_POLLED(Testsome, CallKind::NONE, NO_CALL_ARGS,
+        (incount, array_of_requests, outcount, array_of_indices, batch.statuses),
+        , *outcount > 0 ? NO_POLL : poll_key(incount, batch.handles), if (*outcount != MPI_UNDEFINED) for (int i = 0; i < *outcount; i++)
+            complete_request(batch.handles[array_of_indices[i]], batch.infos[array_of_indices[i]], batch.statuses[i], event.end));
+}
+
+// Постоянный запрос уходит из таблицы только здесь
+MPITRACE_EXPORT int MPI_Request_free(MPI_Request *request) {
+    MPI_Request handle = *request;
+    TRACE_MPI_CALL_HOOKED(Request_free, CallKind::NONE, NO_CALL_ARGS, (request),
+        , request_table.erase(handle));
+}
+
+
+/* Окна RMA: операции и эпохи */
+
+// Вызывается до замера: окно, целевой ранг в MPI_COMM_WORLD и эпоха,
+// к которой относится вызов (для закрывающих - та, что закрывается)
+static inline void fill_window(EventRecord& event, MPI_Win win, int target, EpochAction action, CallKind kind) {
+    if (global_collector.profiling() || win == MPI_WIN_NULL) return;
+    WinInfo& info = win_registry.get(win);
+    event.flags |= WINDOW;
+    event.data = info.id;
+    event.comm = info.comm;
+    if (target >= 0) event.peer = info.to_world(target);
+    // У Win_fence вместо закрываемой эпохи (предыдущий fence окна) - номер
+    // коллектива на окне: окно синхронизирует свою копию коммуникатора
+    if (is_collective(kind)) {
+        event.flags |= INSTANCE;
+        event.link = info.collectives++;
+        return;
+    }
+    event.link = info.closes(action, target);
+}
+
+static inline void update_epoch(MPI_Win win, EpochAction action, int target, uint32_t event_index) {
+    if (global_collector.profiling() || win == MPI_WIN_NULL) return;
+    win_registry.get(win).apply(action, target, event_index);
+}
+
+// Неудачные проверки одной эпохи PSCW сливаются в ряд опросов
+MPITRACE_EXPORT int MPI_Win_test(MPI_Win win, int *flag) {
+    TRACE_MPI_CALL_POLLED(Win_test, CallKind::NONE, NO_CALL_ARGS, (win, flag),
+        fill_window(event, win, MPI_PROC_NULL, EpochAction::WAIT, CallKind::NONE),
+        *flag ? NO_POLL : (uint64_t(event.data) << 1) | 1,
+        if (*flag) update_epoch(win, EpochAction::WAIT, MPI_PROC_NULL, event_index));
+}
+
+
+/* Файловый ввод-вывод */
+
+// Вызывается до замера: идентификатор файла и смещение в байтах от начала
+// файла (смещение в etype переводится через вид файла)
+static inline void fill_file(EventRecord& event, MPI_File fh, MPI_Offset offset, FileMode mode, CallKind kind) {
+    if (global_collector.profiling() || fh == MPI_FILE_NULL) return;
+    FileInfo& info = file_registry.get(fh);
+    event.flags |= FILE_IO;
+    if (mode == FileMode::COLLECTIVE) event.flags |= COLLECTIVE;
+    event.data = info.id;
+    event.comm = info.comm;
+    // Коллективы файла идут по его копии коммуникатора: нумерация своя
+    if (is_collective(kind)) {
+        event.flags |= INSTANCE;
+        event.link = info.collectives++;
+    }
+    if (offset == FILE_POINTER && PMPI_File_get_position(fh, &offset) != MPI_SUCCESS) return;
+    MPI_Offset byte_offset;
+    if (offset >= 0 && PMPI_File_get_byte_offset(fh, offset, &byte_offset) == MPI_SUCCESS) {
+        event.offset = static_cast<uint64_t>(byte_offset);
+    }
+}
+
+
+/* Остальные функции MPI-3.1 генерируются из таблицы */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+#define MPI_FUNCTION(func_name, kind, params, args, peer, count, datatype, comm, root, tag) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args); \
+    }
+
+#define MPI_COMM_CREATE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, newcomm) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            , comm_registry.add(*(newcomm))); \
+    }
+
+#define MPI_COMM_FREE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, freed) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            comm_registry.remove(*(freed)), ); \
+    }
+
+// comm вычисляется один раз: у Imrecv это снятие записи MessageTable
+#define MPI_REQUEST_POST(func_name, kind, params, args, peer, count, datatype, request_comm, root, tag, request) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, request_comm, root, tag}), args, \
+            , track_request(*(request), event, event_index, trace_args.comm, CallKind::kind == CallKind::RECV, false)); \
+    }
+
+#define MPI_REQUEST_INIT(func_name, kind, params, args, peer, count, datatype, comm, root, tag, request) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            , track_request(*(request), event, event_index, comm, CallKind::kind == CallKind::RECV, true)); \
+    }
+
+// Статус заполняется заранее: при неудачной пробе (flag = 0) MPI его не трогает
+#define MPI_WITH_STATUS(func_name, kind, params, args, peer, count, datatype, comm, root, tag, status) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        MPI_Status trace_status; \
+        if (status == MPI_STATUS_IGNORE) status = &trace_status; \
+        status->MPI_SOURCE = MPI_ANY_SOURCE; \
+        TRACE_MPI_CALL(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag, status}), args); \
+    }
+
+// Iprobe, Improbe: неудачные пробы одного источника и тега сливаются в ряд
+#define MPI_PROBE_POLL(func_name, kind, params, args, peer, count, datatype, comm, root, tag, flag, status) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        MPI_Status trace_status; \
+        if (status == MPI_STATUS_IGNORE) status = &trace_status; \
+        status->MPI_SOURCE = MPI_ANY_SOURCE; \
+        TRACE_MPI_CALL_POLLED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag, status}), args, \
+            , *(flag) ? NO_POLL : (uint64_t(event.comm) << 32 ^ uint64_t(uint32_t(peer)) << 16 ^ uint32_t(tag)) | 1, ); \
+    }
+
+#define MPI_MATCHED_PROBE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, message, status) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        MPI_Status trace_status; \
+        if (status == MPI_STATUS_IGNORE) status = &trace_status; \
+        status->MPI_SOURCE = MPI_ANY_SOURCE; \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag, status}), args, \
+            , message_table.insert(*(message), comm)); \
+    }
+
+#define MPI_MATCHED_PROBE_POLL(func_name, kind, params, args, peer, count, datatype, comm, root, tag, flag, message, status) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        MPI_Status trace_status; \
+        if (status == MPI_STATUS_IGNORE) status = &trace_status; \
+        status->MPI_SOURCE = MPI_ANY_SOURCE; \
+        TRACE_MPI_CALL_POLLED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag, status}), args, \
+            , *(flag) ? NO_POLL : (uint64_t(event.comm) << 32 ^ uint64_t(uint32_t(peer)) << 16 ^ uint32_t(tag)) | 1, \
+            if (*(flag)) message_table.insert(*(message), comm)); \
+    }
+
+// Событие вызова описывает отправку; статус нужен приёмной половине
+#define MPI_SENDRECV(func_name, kind, params, args, peer, count, datatype, comm, root, tag, recvtype, status) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        MPI_Status trace_status; \
+        if (status == MPI_STATUS_IGNORE) status = &trace_status; \
+        status->MPI_SOURCE = MPI_ANY_SOURCE; \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            , complete_exchange(event, event_index, comm, recvtype, *status)); \
+    }
+
+#define MPI_TYPE_FREE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, type) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            type_sizes.remove(*(type)), ); \
+    }
+
+#define MPI_WIN_CREATE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, newwin) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            , win_registry.add(*(newwin), comm, comm_registry.get(comm).id)); \
+    }
+
+#define MPI_WIN_FREE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, freed) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            win_registry.remove(*(freed)), ); \
+    }
+
+#define MPI_RMA_OP(func_name, kind, params, args, peer, count, datatype, comm, root, tag, win) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_window(event, win, peer, EpochAction::SYNC, CallKind::kind), ); \
+    }
+
+#define MPI_RMA_REQUEST(func_name, kind, params, args, peer, count, datatype, comm, root, tag, win, request) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_window(event, win, peer, EpochAction::SYNC, CallKind::kind), \
+            track_request(*(request), event, event_index, MPI_COMM_NULL, false, false)); \
+    }
+
+#define MPI_RMA_EPOCH(func_name, kind, params, args, peer, count, datatype, comm, root, tag, win, action, target) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_window(event, win, target, EpochAction::action, CallKind::kind), \
+            update_epoch(win, EpochAction::action, target, event_index)); \
+    }
+
+#define MPI_FILE_OPEN(func_name, kind, params, args, peer, count, datatype, comm, root, tag, filename, fh) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            , file_registry.add(*(fh), comm, comm_registry.get(comm).id, filename)); \
+    }
+
+// Файл уходит из реестра до вызова: File_close обнуляет *fh
+#define MPI_FILE_CLOSE(func_name, kind, params, args, peer, count, datatype, comm, root, tag, fh) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_file(event, *(fh), UNKNOWN_OFFSET, FileMode::COLLECTIVE, CallKind::kind); file_registry.close(*(fh)), ); \
+    }
+
+#define MPI_FILE_CALL(func_name, kind, params, args, peer, count, datatype, comm, root, tag, fh) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_file(event, fh, UNKNOWN_OFFSET, FileMode::INDEPENDENT, CallKind::kind), ); \
+    }
+
+#define MPI_FILE_IO(func_name, kind, params, args, peer, count, datatype, comm, root, tag, fh, offset, op, mode) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_file(event, fh, offset, FileMode::mode, CallKind::kind), \
+            file_registry.account(fh, FileOp::op, message_bytes(trace_args), event.end - event.start)); \
+    }
+
+// Время в сводке - только время постановки операции, без ожидания
+#define MPI_FILE_IO_REQUEST(func_name, kind, params, args, peer, count, datatype, comm, root, tag, fh, offset, op, mode, request) \
+    MPITRACE_EXPORT int MPI_##func_name params { \
+        TRACE_MPI_CALL_HOOKED(func_name, CallKind::kind, (CallArgs{peer, count, datatype, comm, root, tag}), args, \
+            fill_file(event, fh, offset, FileMode::mode, CallKind::kind), \
+            file_registry.account(fh, FileOp::op, message_bytes(trace_args), event.end - event.start); \
+            track_request(*(request), event, event_index, MPI_COMM_NULL, false, false)); \
+    }
+
+#include "mpi_functions.def"
+#undef MPI_FUNCTION
+#undef MPI_COMM_CREATE
+#undef MPI_COMM_FREE
+#undef MPI_REQUEST_POST
+#undef MPI_REQUEST_INIT
+#undef MPI_WITH_STATUS
+#undef MPI_PROBE_POLL
+#undef MPI_MATCHED_PROBE
+#undef MPI_MATCHED_PROBE_POLL
+#undef MPI_SENDRECV
+#undef MPI_TYPE_FREE
+#undef MPI_WIN_CREATE
+#undef MPI_WIN_FREE
+#undef MPI_RMA_OP
+#undef MPI_RMA_REQUEST
+#undef MPI_RMA_EPOCH
+#undef MPI_FILE_OPEN
+#undef MPI_FILE_CLOSE
+#undef MPI_FILE_CALL
+#undef MPI_FILE_IO
+#undef MPI_FILE_IO_REQUEST
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,98 @@
+#pragma once
+#include <omp-tools.h>
+#include <cstdint>
+#include <cstdlib>
+
+// Состояние инструмента OMPT (ompt_start_tool в new_mpi.cpp).
+// Границы parallel, work и ожиданий синхронизации вложены в пределах потока,
+// поэтому начала хранятся в стеке потока, а колбэки не берут блокировок:
+// событие пишется в буфер потока коллектора.
+// Среда сообщает не все концы (libomp для кода GCC: у single только начало),
+// поэтому конец ищет ближайшее начало того же вида, а непарные сбрасываются.
+struct OmpScopes {
+    static constexpr uint32_t MAX_DEPTH = 32;
+    // Вид области: конструкция и её подвид (ompt_work_t, ompt_sync_region_t)
+    static constexpr uint32_t PARALLEL = 1 << 8;
+    static constexpr uint32_t WORK = 2 << 8;
+    static constexpr uint32_t SYNC = 3 << 8;
+
+    struct Scope {
+        uint32_t kind;
+        uint64_t start;
+        uint64_t count;  // размер команды (parallel), число итераций (work)
+    };
+    Scope scopes[MAX_DEPTH];
+    uint32_t depth = 0;
+
+    // При переполнении теряется самое внешнее начало
+    void push(uint32_t kind, uint64_t start, uint64_t count) {
+        if (depth == MAX_DEPTH) {
+            for (uint32_t i = 1; i < MAX_DEPTH; i++) scopes[i - 1] = scopes[i];
+            depth--;
+        }
+        scopes[depth++] = {kind, start, count};
+    }
+
+    bool pop(uint32_t kind, Scope& scope) {
+        uint32_t found = depth;
+        while (found && scopes[found - 1].kind != kind) found--;
+        if (!found) return false;
+        scope = scopes[found - 1];
+        depth = found - 1;
+        return true;
+    }
+};
+
+// Номера имён событий: регистрируются один раз в ompt_initialize.
+// MPITRACE_OMPT=0 выключает инструмент, MPITRACE_OMPT_TASKS=1 пишет каждую
+// задачу отдельно (по умолчанию подряд идущие задачи потока сливаются в ряд).
+struct OmpNames {
+    static constexpr int SYNC_KINDS = 11;  // ompt_sync_region_t, с 1
+    static constexpr int WORK_KINDS = 9;   // ompt_work_t, с 1
+
+    uint16_t parallel = 0;
+    uint16_t task = 0;
+    uint16_t sync[SYNC_KINDS] = {};
+    uint16_t work[WORK_KINDS] = {};
+    bool each_task = false;
+
+    static bool enabled() {
+        const char* value = std::getenv("MPITRACE_OMPT");
+        return !value || std::atoi(value) != 0;
+    }
+
+    template <class Intern>
+    void init(Intern intern) {
+        const char* tasks = std::getenv("MPITRACE_OMPT_TASKS");
+        each_task = tasks && std::atoi(tasks) != 0;
+        parallel = intern("omp_parallel");
+        task = intern("omp_task");
+        uint16_t barrier = intern("omp_barrier");
+        uint16_t implicit = intern("omp_barrier_implicit");
+        for (uint16_t& name : sync) name = barrier;
+        sync[ompt_sync_region_barrier_implicit] = implicit;
+        sync[ompt_sync_region_barrier_implicit_workshare] = implicit;
+        sync[ompt_sync_region_barrier_implicit_parallel] = implicit;
+        sync[ompt_sync_region_barrier_implementation] = intern("omp_barrier_implementation");
+        sync[ompt_sync_region_barrier_teams] = intern("omp_barrier_teams");
+        sync[ompt_sync_region_taskwait] = intern("omp_taskwait");
+        sync[ompt_sync_region_taskgroup] = intern("omp_taskgroup");
+        sync[ompt_sync_region_reduction] = intern("omp_reduction");
+        for (uint16_t& name : work) name = intern("omp_work");
+        work[ompt_work_loop] = intern("omp_loop");
+        work[ompt_work_sections] = intern("omp_sections");
+        work[ompt_work_single_executor] = intern("omp_single");
+        work[ompt_work_single_other] = intern("omp_single_other");
+        work[ompt_work_workshare] = intern("omp_workshare");
+        work[ompt_work_distribute] = intern("omp_distribute");
+        work[ompt_work_taskloop] = intern("omp_taskloop");
+    }
+
+    uint16_t sync_name(int kind) const {
+        return kind > 0 && kind < SYNC_KINDS ? sync[kind] : sync[0];
+    }
+
+    uint16_t work_name(int kind) const {
+        return kind > 0 && kind < WORK_KINDS ? work[kind] : work[0];
+    }
+};
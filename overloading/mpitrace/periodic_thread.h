@@ -0,0 +1,39 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Фоновый поток, вызывающий функцию с заданным периодом до stop():
+// показания памяти (heap_tracker.h), разбор колец снимков стека (stack_sampler.h)
+class PeriodicThread {
+private:
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stop = false;
+
+public:
+    template <class Function>
+    void start(std::chrono::milliseconds interval, Function function) {
+        if (interval.count() <= 0) return;
+        _thread = std::thread([this, interval, function] {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (!_wake.wait_for(lock, interval, [this] { return _stop; })) function();
+        });
+    }
+
+    void stop() {
+        if (!_thread.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    ~PeriodicThread() {
+        stop();
+    }
+};
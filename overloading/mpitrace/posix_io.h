@@ -0,0 +1,54 @@
+#pragma once
+#include <dlfcn.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+// Ввод-вывод POSIX в обход MPI-IO: open/read/write/... перехватываются
+// через LD_PRELOAD, настоящие функции берутся dlsym(RTLD_NEXT).
+// Пишутся только дескрипторы, открытые через open между MPI_Init и
+// записью трассы: сокеты, каналы и stdio MPI и самой библиотеки не
+// попадают в трассу, а чужой дескриптор стоит одного чтения флага.
+class PosixFiles {
+private:
+    static constexpr int MAX_FD = 1 << 16;
+    std::atomic<bool> _tracked[MAX_FD] = {};
+    uint64_t _small = 4096;
+    bool _enabled = true;
+
+public:
+    // MPITRACE_POSIX=0 выключает перехват; MPITRACE_POSIX_SMALL - порог
+    // в байтах, ниже которого чтения и записи одного дескриптора сливаются
+    // в ряд (0 - писать каждый вызов)
+    void init() {
+        if (const char* value = std::getenv("MPITRACE_POSIX")) _enabled = std::atoi(value) != 0;
+        if (const char* value = std::getenv("MPITRACE_POSIX_SMALL")) _small = std::strtoull(value, nullptr, 10);
+    }
+
+    bool enabled() const {
+        return _enabled;
+    }
+
+    bool small(uint64_t bytes) const {
+        return bytes < _small;
+    }
+
+    bool tracked(int fd) const {
+        return fd >= 0 && fd < MAX_FD && _tracked[fd].load(std::memory_order_relaxed);
+    }
+
+    void track(int fd) {
+        if (fd >= 0 && fd < MAX_FD) _tracked[fd].store(true, std::memory_order_relaxed);
+    }
+
+    // Номер может быть сразу выдан другому open
+    void untrack(int fd) {
+        if (fd >= 0 && fd < MAX_FD) _tracked[fd].store(false, std::memory_order_relaxed);
+    }
+};
+
+// Следующее определение функции после libmpitrace (обычно libc)
+template <typename Function>
+inline Function next_function(const char* name) {
+    return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+}
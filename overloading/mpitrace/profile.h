@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "function_table.h"
+
+// Сводка по одной функции. Гистограмма длительностей логарифмическая:
+// корзина k содержит вызовы длительностью [2^(k-1), 2^k) тиков.
+struct FunctionProfile {
+    static constexpr size_t BUCKETS = 40;
+
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+    uint64_t bytes = 0;
+    std::array<uint64_t, BUCKETS> histogram{};
+};
+
+// Профиль процесса: таблица фиксированного размера по FunctionId,
+// память не зависит от числа вызовов
+class Profile {
+private:
+    std::array<FunctionProfile, FUNCTION_COUNT> _functions{};
+
+    // Поля, которые складываются при сведении: count, total, bytes, гистограмма
+    static constexpr size_t SUM_FIELDS = 3 + FunctionProfile::BUCKETS;
+
+public:
+    void record(FunctionId id, uint64_t ticks, uint64_t bytes) {
+        FunctionProfile& f = _functions[id];
+        f.count++;
+        f.total += ticks;
+        f.min = std::min(f.min, ticks);
+        f.max = std::max(f.max, ticks);
+        f.bytes += bytes;
+        size_t bucket = ticks ? 64 - __builtin_clzll(ticks) : 0;
+        f.histogram[std::min(bucket, FunctionProfile::BUCKETS - 1)]++;
+    }
+
+    // Профиль другого потока того же процесса
+    void merge(const Profile& other) {
+        for (size_t i = 0; i < FUNCTION_COUNT; i++) {
+            FunctionProfile& f = _functions[i];
+            const FunctionProfile& o = other._functions[i];
+            if (!o.count) continue;
+            f.count += o.count;
+            f.total += o.total;
+            f.min = std::min(f.min, o.min);
+            f.max = std::max(f.max, o.max);
+            f.bytes += o.bytes;
+            for (size_t k = 0; k < FunctionProfile::BUCKETS; k++) f.histogram[k] += o.histogram[k];
+        }
+    }
+
+    const FunctionProfile& operator[](FunctionId id) const {
+        return _functions[id];
+    }
+
+    // Сведение на ранг 0 (коллективная операция, до PMPI_Finalize).
+    // min и max - по всем рангам; результат имеет смысл только на root.
+    Profile reduce(MPI_Comm comm) const {
+        std::vector<uint64_t> sums(FUNCTION_COUNT * SUM_FIELDS), mins(FUNCTION_COUNT), maxs(FUNCTION_COUNT);
+        for (size_t i = 0; i < FUNCTION_COUNT; i++) {
+            const FunctionProfile& f = _functions[i];
+            uint64_t* s = &sums[i * SUM_FIELDS];
+            s[0] = f.count;
+            s[1] = f.total;
+            s[2] = f.bytes;
+            std::copy(f.histogram.begin(), f.histogram.end(), s + 3);
+            mins[i] = f.min;
+            maxs[i] = f.max;
+        }
+        std::vector<uint64_t> total_sums(sums.size()), total_mins(FUNCTION_COUNT), total_maxs(FUNCTION_COUNT);
+        PMPI_Reduce(sums.data(), total_sums.data(), static_cast<int>(sums.size()), MPI_UINT64_T, MPI_SUM, 0, comm);
+        PMPI_Reduce(mins.data(), total_mins.data(), FUNCTION_COUNT, MPI_UINT64_T, MPI_MIN, 0, comm);
+        PMPI_Reduce(maxs.data(), total_maxs.data(), FUNCTION_COUNT, MPI_UINT64_T, MPI_MAX, 0, comm);
+
+        Profile result;
+        for (size_t i = 0; i < FUNCTION_COUNT; i++) {
+            FunctionProfile& f = result._functions[i];
+            const uint64_t* s = &total_sums[i * SUM_FIELDS];
+            f.count = s[0];
+            f.total = s[1];
+            f.bytes = s[2];
+            std::copy(s + 3, s + SUM_FIELDS, f.histogram.begin());
+            f.min = total_mins[i];
+            f.max = total_maxs[i];
+        }
+        return result;
+    }
+
+    // Текстовая таблица, времена в нс; функции без вызовов пропускаются.
+    // Гистограмма - пары <верхняя граница корзины, нс>:<число вызовов>.
+    void write(const std::string& path, const std::string& title, double ns_per_tick) const {
+        std::ofstream file(path);
+        file << "# " << title << "\n";
+        file << "# function calls total_ns min_ns max_ns bytes histogram\n";
+        for (size_t i = 0; i < FUNCTION_COUNT; i++) {
+            const FunctionProfile& f = _functions[i];
+            if (!f.count) continue;
+            file << function_names[i] << " " << f.count
+                 << " " << static_cast<uint64_t>(f.total * ns_per_tick)
+                 << " " << static_cast<uint64_t>(f.min * ns_per_tick)
+                 << " " << static_cast<uint64_t>(f.max * ns_per_tick)
+                 << " " << f.bytes;
+            for (size_t k = 0; k < FunctionProfile::BUCKETS; k++) {
+                if (!f.histogram[k]) continue;
+                file << " " << static_cast<uint64_t>((uint64_t(1) << k) * ns_per_tick) << ":" << f.histogram[k];
+            }
+            file << "\n";
+        }
+    }
+};
@@ -0,0 +1,133 @@
+#pragma once
+#include <stdint.h>
+#ifndef __cplusplus
+#include <stdatomic.h>
+#endif
+
+// Пользовательские регионы: фазы вычислений между вызовами MPI.
+//
+//   C и C++:  PT_REGION_BEGIN("solve"); ... PT_REGION_END("solve");
+//   C++:      static const pt::Region solve("solve");
+//             pt::Scope scope(solve);         // регион до конца блока
+//             PT_SCOPE("solve");              // то же одной строкой
+//
+// Имя регистрируется один раз на место вызова (static), поэтому вход в
+// регион - только чтение часов и запись в стек потока, выход - одно
+// событие REGION с глубиной вложенности. Непарный PT_REGION_END закрывает
+// и вложенные в него регионы.
+//
+// Функции библиотеки объявлены слабыми: без libmpitrace (LD_PRELOAD или
+// -lmpitrace) макросы ничего не делают. С -DPT_DISABLE кода нет вовсе.
+
+#define PT_NO_REGION UINT32_MAX
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t pt_region_register(const char* name) __attribute__((weak));
+void pt_region_enter(uint32_t region) __attribute__((weak));
+void pt_region_exit(uint32_t region) __attribute__((weak));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define PT_CONCAT_(a, b) a##b
+#define PT_CONCAT(a, b) PT_CONCAT_(a, b)
+
+#ifndef PT_DISABLE
+
+// Повторная регистрация из другого потока даёт тот же номер, поэтому
+// в C достаточно атомарной переменной без упорядочивания (OpenMP-потоки
+// входят в регион одновременно); в C++ - инициализация static
+#ifdef __cplusplus
+#define PT_REGION_CALL_(name, call)                                      \
+    do {                                                                 \
+        if (call) {                                                      \
+            static const uint32_t pt_region_ = pt_region_register(name); \
+            call(pt_region_);                                            \
+        }                                                                \
+    } while (0)
+#else
+#define PT_REGION_CALL_(name, call)                                      \
+    do {                                                                 \
+        static _Atomic uint32_t pt_region_ = PT_NO_REGION;               \
+        if (call) {                                                      \
+            uint32_t pt_id_ = atomic_load_explicit(&pt_region_, memory_order_relaxed); \
+            if (pt_id_ == PT_NO_REGION) {                                \
+                pt_id_ = pt_region_register(name);                       \
+                atomic_store_explicit(&pt_region_, pt_id_, memory_order_relaxed); \
+            }                                                            \
+            call(pt_id_);                                                \
+        }                                                                \
+    } while (0)
+#endif
+
+#define PT_REGION_BEGIN(name) PT_REGION_CALL_(name, pt_region_enter)
+#define PT_REGION_END(name) PT_REGION_CALL_(name, pt_region_exit)
+
+#else
+
+#define PT_REGION_BEGIN(name) ((void)0)
+#define PT_REGION_END(name) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+namespace pt {
+
+#ifndef PT_DISABLE
+
+class Region {
+private:
+    uint32_t _id;
+
+public:
+    explicit Region(const char* name)
+        : _id(pt_region_register ? pt_region_register(name) : PT_NO_REGION) {}
+
+    uint32_t id() const {
+        return _id;
+    }
+};
+
+class Scope {
+private:
+    uint32_t _id;
+
+public:
+    explicit Scope(const Region& region) : _id(region.id()) {
+        if (pt_region_enter) pt_region_enter(_id);
+    }
+
+    ~Scope() {
+        if (pt_region_exit) pt_region_exit(_id);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+#define PT_SCOPE(name)                                                   \
+    static const pt::Region PT_CONCAT(pt_region_, __LINE__)(name);       \
+    pt::Scope PT_CONCAT(pt_scope_, __LINE__)(PT_CONCAT(pt_region_, __LINE__))
+
+#else
+
+class Region {
+public:
+    explicit Region(const char*) {}
+};
+
+class Scope {
+public:
+    explicit Scope(const Region&) {}
+};
+
+#define PT_SCOPE(name) ((void)0)
+
+#endif
+
+}  // namespace pt
+#endif
@@ -0,0 +1,191 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <mpi.h>
+
+// Неблокирующая операция от начала (Isend, Irecv, Start, ...) до завершения
+struct RequestInfo {
+    uint32_t post;       // номер события, начавшего операцию
+    uint16_t name;       // имя этого события
+    bool     recv;       // источник и тег берутся из MPI_Status
+    bool     persistent; // запрос *_init: остаётся в таблице после завершения
+    bool     active;     // постоянный запрос между Start и завершением
+    int32_t  peer;       // ранг в MPI_COMM_WORLD на момент начала
+    int32_t  tag;
+    uint32_t comm;       // идентификатор из CommRegistry
+    uint64_t bytes;      // объём, указанный при начале операции
+    MPI_Comm handle;     // для перевода MPI_SOURCE в ранг MPI_COMM_WORLD
+};
+
+// Открытая адресация с линейным пробированием по значению MPI_Request.
+// Ячейка захватывается CAS по ключу, поэтому вставка и удаление не
+// требуют блокировок; запрос в каждый момент принадлежит одному потоку,
+// и данные ячейки пишет только он. Длина пробирования ограничена:
+// если места нет, запрос просто не отслеживается.
+//
+// Удалённая ячейка, за которой пусто, снова становится пустой (вместе с
+// удалёнными перед ней), иначе за долгий запуск удалённые заполнили бы
+// цепочки и каждый промах проходил бы все MAX_PROBE ячеек. Если вставка
+// прошла мимо ячейки, пока её освобождали, она восстанавливает цепочку:
+// освобождение читает следующую ячейку, вставка - предыдущие, обе seq_cst.
+class RequestTable {
+private:
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr uint64_t DELETED = ~uint64_t(0);
+    static constexpr size_t CAPACITY = 1 << 14;
+    static constexpr size_t MAX_PROBE = 64;
+
+    struct Slot {
+        std::atomic<uint64_t> key{EMPTY};
+        RequestInfo info;
+    };
+
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<uint64_t> _dropped{0};
+
+    static_assert(sizeof(MPI_Request) <= sizeof(uint64_t), "MPI_Request must fit in 64 bits");
+
+    static uint64_t key_of(MPI_Request request) {
+        uint64_t key = 0;
+        std::memcpy(&key, &request, sizeof(request));
+        return key;
+    }
+
+    static size_t hash(uint64_t key) {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & (CAPACITY - 1);
+    }
+
+    static size_t next(size_t index) {
+        return (index + 1) & (CAPACITY - 1);
+    }
+
+    void remove(Slot& slot) {
+        size_t index = static_cast<size_t>(&slot - _slots.get());
+        if (_slots[next(index)].key.load(std::memory_order_seq_cst) != EMPTY) {
+            slot.key.store(DELETED, std::memory_order_release);
+            return;
+        }
+        slot.key.store(EMPTY, std::memory_order_seq_cst);
+        for (size_t i = 0; i < MAX_PROBE; i++) {
+            // Следующая могла быть занята вставкой после освобождения
+            if (_slots[index].key.load(std::memory_order_seq_cst) != EMPTY) break;
+            index = (index - 1) & (CAPACITY - 1);
+            uint64_t expected = DELETED;
+            if (!_slots[index].key.compare_exchange_strong(expected, EMPTY, std::memory_order_seq_cst)) break;
+        }
+    }
+
+    // Ячейки от начала цепочки до занятой вставкой не должны быть пустыми
+    void restore_chain(size_t index, size_t taken) {
+        for (; index != taken; index = next(index)) {
+            uint64_t expected = EMPTY;
+            if (_slots[index].key.load(std::memory_order_seq_cst) == EMPTY) {
+                _slots[index].key.compare_exchange_strong(expected, DELETED, std::memory_order_seq_cst);
+            }
+        }
+    }
+
+    Slot* lookup(uint64_t key) {
+        if (!_slots) return nullptr;
+        size_t index = hash(key);
+        for (size_t i = 0; i < MAX_PROBE; i++, index = next(index)) {
+            uint64_t current = _slots[index].key.load(std::memory_order_acquire);
+            if (current == key) return &_slots[index];
+            if (current == EMPTY) return nullptr;
+        }
+        return nullptr;
+    }
+
+public:
+    void init() {
+        _slots = std::make_unique<Slot[]>(CAPACITY);
+    }
+
+    // Повторная вставка того же запроса (не замеченное завершение) перезаписывает ячейку
+    void insert(MPI_Request request, const RequestInfo& info) {
+        if (!_slots || request == MPI_REQUEST_NULL) return;
+        uint64_t key = key_of(request);
+        if (Slot* slot = lookup(key)) {
+            slot->info = info;
+            return;
+        }
+        size_t first = hash(key);
+        size_t index = first;
+        for (size_t i = 0; i < MAX_PROBE; i++, index = next(index)) {
+            uint64_t current = _slots[index].key.load(std::memory_order_relaxed);
+            if (current != EMPTY && current != DELETED) continue;
+            if (_slots[index].key.compare_exchange_strong(current, key, std::memory_order_seq_cst)) {
+                _slots[index].info = info;
+                restore_chain(first, index);
+                return;
+            }
+        }
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    RequestInfo* find(MPI_Request request) {
+        if (request == MPI_REQUEST_NULL) return nullptr;
+        Slot* slot = lookup(key_of(request));
+        return slot ? &slot->info : nullptr;
+    }
+
+    // Копия записи до вызова Wait*/Test*: завершённый дескриптор MPI может
+    // сразу выдать другому потоку, и новый запрос перезапишет ячейку.
+    // Без записи или для неактивного запроса копия получает active = false.
+    void copy(MPI_Request request, RequestInfo& out) {
+        RequestInfo* info = find(request);
+        if (info) {
+            out = *info;
+        } else {
+            out.active = false;
+        }
+    }
+
+    void erase(MPI_Request request) {
+        if (request == MPI_REQUEST_NULL) return;
+        if (Slot* slot = lookup(key_of(request))) remove(*slot);
+    }
+
+    // Завершение по копии: ячейка меняется, только если её не занял новый запрос
+    void release(MPI_Request request, const RequestInfo& copy) {
+        Slot* slot = request == MPI_REQUEST_NULL ? nullptr : lookup(key_of(request));
+        if (!slot || slot->info.post != copy.post) return;
+        if (copy.persistent) slot->info.active = false;
+        else remove(*slot);
+    }
+
+    uint64_t dropped() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+};
+
+// Коммуникатор сообщения, найденного Mprobe/Improbe: MPI_Message его не
+// отдаёт, а без него источник Mrecv/Imrecv не перевести в MPI_COMM_WORLD.
+// Согласованные пробы редки, поэтому хватает мьютекса.
+class MessageTable {
+private:
+    std::unordered_map<MPI_Message, MPI_Comm> _comms;
+    std::mutex _mutex;
+
+public:
+    void insert(MPI_Message message, MPI_Comm comm) {
+        if (message == MPI_MESSAGE_NULL || message == MPI_MESSAGE_NO_PROC) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _comms[message] = comm;
+    }
+
+    // Приём забирает сообщение: дескриптор после него может быть выдан снова
+    MPI_Comm take(MPI_Message message) {
+        if (message == MPI_MESSAGE_NULL || message == MPI_MESSAGE_NO_PROC) return MPI_COMM_NULL;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _comms.find(message);
+        if (it == _comms.end()) return MPI_COMM_NULL;
+        MPI_Comm comm = it->second;
+        _comms.erase(it);
+        return comm;
+    }
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Кольцевая очередь без блокировок: один производитель, один потребитель
+template <class T, size_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "N must be a power of two");
+
+private:
+    std::array<T, N> _items;
+    alignas(64) std::atomic<size_t> _head{0};  // читает потребитель
+    alignas(64) std::atomic<size_t> _tail{0};  // пишет производитель
+
+public:
+    bool push(const T& item) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == N) return false;
+        _items[tail & (N - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+        item = _items[head & (N - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+#include <pthread.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "trace_format.h"
+
+// Статистические снимки стека (MPITRACE_SAMPLE_US - период по процессорному
+// времени потока, 0 - выключено). У каждого потока трассы свой таймер
+// timer_create(CLOCK_THREAD_CPUTIME_ID), сигнал SIGPROF приходит в этот поток.
+// Обработчик только читает регистры и проходит по цепочке указателей кадров
+// (нужен -fno-omit-frame-pointer у приложения) в заранее выделенное кольцо
+// потока; кольца разбирает фоновый поток, имена восстанавливаются после
+// запуска по секции MODULES.
+template <class ClockPolicy>
+class StackSampler {
+private:
+    static constexpr uint32_t MAX_FRAMES = 32;
+    static constexpr uint32_t RING_SLOTS = 512;  // снимков между разборами
+
+    struct Slot {
+        uint64_t time;
+        uint32_t depth;
+        uint64_t frames[MAX_FRAMES];
+    };
+
+    // Кольцо одного производителя (обработчик в своём потоке) и одного потребителя
+    struct SampledThread {
+        uint32_t thread;
+        uintptr_t stack_low = 0;
+        uintptr_t stack_high = 0;
+        timer_t timer{};
+        bool armed = false;
+        std::atomic<uint32_t> head{0};
+        std::atomic<uint32_t> tail{0};
+        std::atomic<uint64_t> dropped{0};
+        Slot slots[RING_SLOTS];
+        SampledThread* next = nullptr;
+    };
+
+    // initial-exec: обращение к TLS из обработчика сигнала
+    __attribute__((tls_model("initial-exec"))) inline static thread_local SampledThread* _self = nullptr;
+    inline static std::atomic<bool> _running{false};
+
+    std::atomic<SampledThread*> _threads{nullptr};
+    long _period_us = 0;
+
+    // Цепочка кадров проверяется по границам стека: кадр без указателя
+    // (код без -fno-omit-frame-pointer) обрывает снимок, а не роняет процесс
+    static uint32_t walk(const ucontext_t* context, const SampledThread& self, uint64_t* frames) {
+#if defined(__x86_64__)
+        uintptr_t pc = context->uc_mcontext.gregs[REG_RIP];
+        uintptr_t fp = context->uc_mcontext.gregs[REG_RBP];
+#elif defined(__aarch64__)
+        uintptr_t pc = context->uc_mcontext.pc;
+        uintptr_t fp = context->uc_mcontext.regs[29];
+#else
+        (void)context;
+        (void)self;
+        (void)frames;
+        return 0;
+#endif
+#if defined(__x86_64__) || defined(__aarch64__)
+        uint32_t depth = 0;
+        frames[depth++] = pc;
+        while (depth < MAX_FRAMES && fp % sizeof(uintptr_t) == 0 && fp >= self.stack_low &&
+               fp + 2 * sizeof(uintptr_t) <= self.stack_high) {
+            const uintptr_t* frame = reinterpret_cast<const uintptr_t*>(fp);
+            uintptr_t caller = frame[0];
+            uintptr_t ret = frame[1];
+            if (!ret) break;
+            frames[depth++] = ret - 1;
+            if (caller <= fp) break;
+            fp = caller;
+        }
+        return depth;
+#endif
+    }
+
+    static void handle(int, siginfo_t*, void* context) {
+        SampledThread* self = _self;
+        if (!self || !_running.load(std::memory_order_relaxed)) return;
+        int saved_errno = errno;
+        uint32_t head = self->head.load(std::memory_order_relaxed);
+        if (head - self->tail.load(std::memory_order_acquire) == RING_SLOTS) {
+            self->dropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            Slot& slot = self->slots[head % RING_SLOTS];
+            slot.time = ClockPolicy::now();
+            slot.depth = walk(static_cast<const ucontext_t*>(context), *self, slot.frames);
+            self->head.store(head + 1, std::memory_order_release);
+        }
+        errno = saved_errno;
+    }
+
+public:
+    bool init() {
+        const char* value = std::getenv("MPITRACE_SAMPLE_US");
+        _period_us = value ? std::atol(value) : 0;
+        return _period_us > 0;
+    }
+
+    bool enabled() const {
+        return _period_us > 0;
+    }
+
+    // Обработчик остаётся установленным и после stop(): SIGPROF по умолчанию
+    // завершает процесс, а сигнал от снятого таймера может быть ещё в пути
+    void start() {
+        struct sigaction action {};
+        action.sa_sigaction = &StackSampler::handle;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        _running.store(true, std::memory_order_release);
+    }
+
+    // В самом потоке, при первом его событии
+    void add_thread(uint32_t thread) {
+        if (!_running.load(std::memory_order_acquire)) return;
+        auto* self = new SampledThread;
+        self->thread = thread;
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+            void* base = nullptr;
+            size_t size = 0;
+            if (pthread_attr_getstack(&attr, &base, &size) == 0) {
+                self->stack_low = reinterpret_cast<uintptr_t>(base);
+                self->stack_high = self->stack_low + size;
+            }
+            pthread_attr_destroy(&attr);
+        }
+        SampledThread* head = _threads.load(std::memory_order_relaxed);
+        do {
+            self->next = head;
+        } while (!_threads.compare_exchange_weak(head, self, std::memory_order_release, std::memory_order_relaxed));
+        _self = self;
+
+        sigevent event {};
+        event.sigev_notify = SIGEV_THREAD_ID;
+        event.sigev_signo = SIGPROF;
+        event._sigev_un._tid = static_cast<pid_t>(syscall(SYS_gettid));
+        if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &self->timer) != 0) return;
+        itimerspec period {};
+        period.it_interval.tv_sec = _period_us / 1000000;
+        period.it_interval.tv_nsec = (_period_us % 1000000) * 1000;
+        period.it_value = period.it_interval;
+        self->armed = timer_settime(self->timer, 0, &period, nullptr) == 0;
+    }
+
+    // Потребитель колец один: фоновый поток, после stop() - поток MPI_Finalize
+    void drain(std::vector<StackSample>& out) {
+        for (SampledThread* self = _threads.load(std::memory_order_acquire); self; self = self->next) {
+            uint32_t tail = self->tail.load(std::memory_order_relaxed);
+            uint32_t head = self->head.load(std::memory_order_acquire);
+            for (; tail != head; tail++) {
+                const Slot& slot = self->slots[tail % RING_SLOTS];
+                out.push_back({slot.time, self->thread, std::vector<uint64_t>(slot.frames, slot.frames + slot.depth)});
+            }
+            self->tail.store(tail, std::memory_order_release);
+        }
+    }
+
+    void stop() {
+        _running.store(false, std::memory_order_release);
+        for (SampledThread* self = _threads.load(std::memory_order_acquire); self; self = self->next) {
+            if (self->armed) timer_delete(self->timer);
+            self->armed = false;
+        }
+    }
+
+    uint64_t dropped() const {
+        uint64_t total = 0;
+        for (SampledThread* self = _threads.load(std::memory_order_acquire); self; self = self->next) {
+            total += self->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    ~StackSampler() {
+        _running.store(false, std::memory_order_release);
+        SampledThread* self = _threads.load(std::memory_order_acquire);
+        while (self) {
+            SampledThread* next = self->next;
+            if (self->armed) timer_delete(self->timer);
+            delete self;
+            self = next;
+        }
+    }
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "event_buffer.h"
+#include "spsc_queue.h"
+#include "trace_writer.h"
+
+// Кодирование буфера в секции STRINGS и EVENTS
+inline void write_buffer(TraceWriter& writer, const EventBuffer& buffer) {
+    writer.write_strings(buffer.first_name, buffer.names);
+    for (size_t i = 0; i < buffer.events.size(); i++) writer.add_event(buffer.events[i], buffer.contexts[i]);
+    writer.flush_block();
+}
+
+// Буферы одного потока приложения и очереди обмена с потоком записи.
+// У каждого потока свой канал, поэтому очереди остаются SPSC.
+struct StreamChannel {
+    std::vector<std::unique_ptr<EventBuffer>> buffers;
+    SpscQueue<EventBuffer*, 64> full;  // поток приложения -> поток записи
+    SpscQueue<EventBuffer*, 64> free;  // поток записи -> поток приложения
+    StreamChannel* next = nullptr;     // список каналов StreamWriter
+};
+
+// Фоновая запись трассы во время работы приложения.
+// Набор буферов каждого потока фиксирован: поток отдаёт заполненный буфер
+// в full и забирает пустой из free; если поток записи не успевает,
+// приложение ждёт свободный буфер, память не растёт.
+class StreamWriter {
+private:
+    TraceWriter _writer;
+    size_t _count = 0;
+    size_t _capacity = 0;
+    std::atomic<StreamChannel*> _channels{nullptr};
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+
+    // Снимки стека (stack_sampler.h) от фонового потока разбора колец
+    std::vector<StackSample> _samples;
+    std::mutex _samples_mutex;
+
+    // Заполненные буферы всех каналов; при stop буферы не возвращаются
+    bool drain(bool stop) {
+        bool written = false;
+        for (StreamChannel* channel = _channels.load(std::memory_order_acquire); channel; channel = channel->next) {
+            EventBuffer* buffer;
+            while (channel->full.pop(buffer)) {
+                write_buffer(_writer, *buffer);
+                written = true;
+                if (stop) continue;
+                buffer->clear();
+                channel->free.push(buffer);
+            }
+        }
+        return written;
+    }
+
+    bool write_samples() {
+        std::vector<StackSample> samples;
+        {
+            std::lock_guard<std::mutex> lock(_samples_mutex);
+            samples.swap(_samples);
+        }
+        if (samples.empty()) return false;
+        _writer.write_samples(samples);
+        return true;
+    }
+
+    void run() {
+        while (true) {
+            bool written = drain(false);
+            if (write_samples() || written) continue;
+            if (_stop.load(std::memory_order_acquire)) {
+                // Буферы и снимки, отданные до установки _stop
+                drain(true);
+                write_samples();
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+public:
+    explicit StreamWriter(TraceWriter&& writer) : _writer(std::move(writer)) {}
+
+    ~StreamWriter() {
+        StreamChannel* channel = _channels.load(std::memory_order_acquire);
+        while (channel) {
+            StreamChannel* next = channel->next;
+            delete channel;
+            channel = next;
+        }
+    }
+
+    TraceWriter& writer() {
+        return _writer;
+    }
+
+    // Заголовок пишется вызывающим до start(); count буферов по capacity событий на поток
+    void start(size_t count, size_t capacity) {
+        _count = count;
+        _capacity = capacity;
+        _thread = std::thread(&StreamWriter::run, this);
+    }
+
+    // Канал нового потока приложения; регистрация без блокировок.
+    // Первый буфер канала отдаётся потоку сразу.
+    StreamChannel* open_channel() {
+        auto* channel = new StreamChannel;
+        for (size_t i = 0; i < _count; i++) channel->buffers.push_back(std::make_unique<EventBuffer>(_capacity));
+        for (size_t i = 1; i < _count; i++) channel->free.push(channel->buffers[i].get());
+        StreamChannel* head = _channels.load(std::memory_order_relaxed);
+        do {
+            channel->next = head;
+        } while (!_channels.compare_exchange_weak(head, channel, std::memory_order_release, std::memory_order_relaxed));
+        return channel;
+    }
+
+    // После finish() буферы никто не забирает: события отбрасываются
+    EventBuffer* exchange(StreamChannel& channel, EventBuffer* full) {
+        if (_stop.load(std::memory_order_acquire)) {
+            full->clear();
+            return full;
+        }
+        while (!channel.full.push(full)) std::this_thread::yield();
+        EventBuffer* buffer;
+        while (!channel.free.pop(buffer)) std::this_thread::yield();
+        return buffer;
+    }
+
+    // Снимки пишутся потоком записи вперемешку с событиями; вызывается до finish()
+    void submit_samples(std::vector<StackSample>& samples) {
+        std::lock_guard<std::mutex> lock(_samples_mutex);
+        _samples.insert(_samples.end(), std::make_move_iterator(samples.begin()), std::make_move_iterator(samples.end()));
+    }
+
+    // Последний, частично заполненный буфер канала; вызывается до finish()
+    void submit(StreamChannel& channel, EventBuffer* last) {
+        while (!channel.full.push(last)) std::this_thread::yield();
+    }
+
+    // После возврата writer() снова принадлежит вызывающему потоку
+    void finish() {
+        _stop.store(true, std::memory_order_release);
+        if (_thread.joinable()) _thread.join();
+    }
+};
@@ -0,0 +1,691 @@
+#pragma once
+#include <string>
+#include <chrono>
+#include <vector>
+#include <iostream>
+#include <mpi.h>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "calling_context.h"
+#include "clock_policy.h"
+#include "comm_registry.h"
+#include "event_buffer.h"
+#include "function_filter.h"
+#include "profile.h"
+#include "stream_writer.h"
+#include "trace_writer.h"
+
+using time_metric = std::chrono::microseconds;
+
+// Режим записи, переменная окружения MPITRACE_MODE:
+//   trace  - события копятся в памяти и пишутся на MPI_Finalize (по умолчанию);
+//   stream - фиксированный набор буферов на поток (MPITRACE_BUFFER_MB, по умолчанию 8 МБ,
+//            MPITRACE_BUFFERS, по умолчанию 2), заполненные буферы пишет фоновый поток;
+//   profile - без временной шкалы, только сводка по функциям (profile.h);
+//            при MPITRACE_PROFILE_REDUCE=1 ранг 0 пишет ещё и сводку по всем рангам
+enum class TraceMode {
+    TRACE,
+    STREAM,
+    PROFILE,
+};
+
+// Состояние записи одного потока. Поля меняет только свой поток, поэтому
+// событие записывается без блокировок; выравнивание по строке кэша, чтобы
+// состояния соседних потоков не делили строки.
+struct alignas(64) ThreadTrace {
+    uint32_t thread = 0;                               // номер в порядке регистрации
+    EventBuffer* current = nullptr;
+    std::vector<std::unique_ptr<EventBuffer>> pages;   // режим trace: все буферы потока по порядку
+    StreamChannel* channel = nullptr;                  // режим stream
+    std::unique_ptr<Profile> profile;                  // режим profile
+
+    // Номера событий выдаются потоку блоками из общего счётчика
+    uint32_t next_id = 0;
+    uint32_t end_id = 0;
+
+    // Незавершённый ряд неудачных опросов (Test*, Iprobe) или мелких
+    // чтений и записей POSIX с одним ключом
+    EventRecord poll{};
+    uint32_t poll_context = NO_CONTEXT;
+    uint64_t poll_key = 0;
+    uint64_t poll_busy = 0;
+    uint64_t poll_bytes = 0;
+    uint32_t poll_count = 0;
+
+    // Открытые пользовательские регионы и функции; глубже MAX_REGIONS только считаются
+    static constexpr uint32_t MAX_REGIONS = 64;
+    struct OpenRegion {
+        uint16_t name;
+        uint64_t address;  // функция (-finstrument-functions), у регионов 0
+        uint64_t start;
+    };
+    OpenRegion regions[MAX_REGIONS];
+    uint32_t depth = 0;
+
+    // Вложенность записей вне вызова MPI (RecordingScope); меняет только
+    // свой поток, close() ждёт нуля
+    std::atomic<uint32_t> active{0};
+
+    ThreadTrace* next = nullptr;  // список всех потоков процесса
+};
+
+template <class ClockPolicy>
+class TraceCollector {
+private:
+    TraceMode _mode = TraceMode::TRACE;
+    std::unique_ptr<StreamWriter> _stream;
+    TraceWriter _writer;
+
+    // Имена меняются один раз на место вызова и передаются при смене буфера,
+    // поэтому мьютекс не попадает на путь записи события
+    StringTable _names;
+    uint32_t _names_flushed = 0;
+    std::mutex _names_mutex;
+    uint16_t _function_name = 0;
+
+    std::vector<ModuleDefinition> _modules;  // карта загрузки на MPI_Init
+    CallingContexts _contexts;
+
+public:
+    // Вызывается в потоке при его первом событии (номер - EventRecord::thread)
+    using ThreadHook = void (*)(uint32_t thread);
+
+private:
+    ThreadHook _thread_hook = nullptr;
+
+    // Потоки регистрируются при первом событии (MPI_THREAD_MULTIPLE)
+    std::atomic<ThreadTrace*> _threads{nullptr};
+    std::atomic<uint32_t> _thread_count{0};
+    std::atomic<uint32_t> _next_id{0};
+    inline static thread_local ThreadTrace* _local = nullptr;
+
+    int _rank_process = 0;
+    // Читаются потоками вне MPI (POSIX, OpenMP, функции, память)
+    std::atomic<bool> _initialized{false};
+    std::atomic<bool> _closed{false};
+    bool _written = false;  // трасса записана: новые страницы не нужны
+    std::string FolderName;
+
+    // Точка отсчёта: момент сразу после PMPI_Init
+    uint64_t _start_ticks = 0;
+    std::chrono::nanoseconds _init_duration{0};
+    std::chrono::system_clock::time_point _system_start;
+
+    // Пары (тики, CLOCK_MONOTONIC) для калибровки на MPI_Init и MPI_Finalize
+    uint64_t _calib_start_ticks = 0;
+    uint64_t _calib_start_ns = 0;
+    uint64_t _calib_end_ticks = 0;
+    uint64_t _calib_end_ns = 0;
+
+    // Режим trace: страницы по 2048 записей, растут без ограничения
+    static constexpr size_t PAGE_EVENTS = 2048;
+    // Номера событий на поток за одно обращение к общему счётчику
+    static constexpr uint32_t ID_BLOCK = 1024;
+
+    static size_t env_size(const char* name, size_t fallback) {
+        const char* value = std::getenv(name);
+        if (!value) return fallback;
+        long long parsed = std::atoll(value);
+        return parsed > 0 ? static_cast<size_t>(parsed) : fallback;
+    }
+
+    TraceWriter& writer() {
+        return _stream ? _stream->writer() : _writer;
+    }
+
+    // Участки, выделяющие память под саму трассу: перехват malloc
+    // (MPITRACE_HEAP) не пишет в них событий, иначе запись вошла бы
+    // в себя же. initial-exec - флаг читается из malloc.
+    __attribute__((tls_model("initial-exec"))) inline static thread_local bool _allocating = false;
+
+    struct AllocationScope {
+        bool saved;
+        AllocationScope() : saved(_allocating) {
+            _allocating = true;
+        }
+        ~AllocationScope() {
+            _allocating = saved;
+        }
+    };
+
+    ThreadTrace& local() {
+        return _local ? *_local : register_thread();
+    }
+
+    // Первое событие потока: свои буферы и добавление в список без блокировок
+    ThreadTrace& register_thread() {
+        AllocationScope scope;
+        auto* trace = new ThreadTrace;
+        trace->thread = _thread_count.fetch_add(1, std::memory_order_relaxed);
+        if (profiling()) {
+            trace->profile = std::make_unique<Profile>();
+        } else if (_stream) {
+            trace->channel = _stream->open_channel();
+            trace->current = trace->channel->buffers[0].get();
+        } else {
+            trace->pages.push_back(std::make_unique<EventBuffer>(PAGE_EVENTS));
+            trace->current = trace->pages.back().get();
+        }
+        ThreadTrace* head = _threads.load(std::memory_order_relaxed);
+        do {
+            trace->next = head;
+        } while (!_threads.compare_exchange_weak(head, trace, std::memory_order_release, std::memory_order_relaxed));
+        _local = trace;
+        if (_thread_hook) _thread_hook(trace->thread);
+        return *trace;
+    }
+
+    // Имена, появившиеся после передачи предыдущего буфера (режим stream)
+    void attach_names(EventBuffer& buffer) {
+        AllocationScope scope;
+        std::lock_guard<std::mutex> lock(_names_mutex);
+        buffer.first_name = _names_flushed;
+        buffer.names.assign(_names.strings().begin() + _names_flushed, _names.strings().end());
+        _names_flushed = static_cast<uint32_t>(_names.size());
+    }
+
+    void rotate(ThreadTrace& trace) {
+        AllocationScope scope;
+        if (_stream) {
+            attach_names(*trace.current);
+            trace.current = _stream->exchange(*trace.channel, trace.current);
+        } else if (_written) {
+            trace.current->clear();
+        } else {
+            trace.pages.push_back(std::make_unique<EventBuffer>(PAGE_EVENTS));
+            trace.current = trace.pages.back().get();
+        }
+    }
+
+    uint32_t append(ThreadTrace& trace, const EventRecord& event, uint32_t context = NO_CONTEXT) {
+        if (trace.next_id == trace.end_id) {
+            trace.next_id = _next_id.fetch_add(ID_BLOCK, std::memory_order_relaxed);
+            trace.end_id = trace.next_id + ID_BLOCK;
+        }
+        EventRecord& stored = trace.current->events.emplace_back(event);
+        stored.id = trace.next_id++;
+        stored.thread = trace.thread;
+        trace.current->contexts.push_back(context);
+        uint32_t id = stored.id;
+        if (trace.current->full()) rotate(trace);
+        return id;
+    }
+
+    // Закрывает самый внутренний открытый регион
+    void close_region(ThreadTrace& trace, uint64_t end) {
+        trace.depth--;
+        const ThreadTrace::OpenRegion& region = trace.regions[trace.depth];
+        EventRecord event = make_event(region.name);
+        event.flags = region.address ? REGION | FUNCTION : REGION;
+        event.offset = region.address ? region.address : NO_OFFSET;
+        event.start = region.start;
+        event.end = end;
+        event.data = trace.depth;
+        if (trace.poll_count) flush_poll(trace);
+        append(trace, event);
+    }
+
+    void flush_poll(ThreadTrace& trace) {
+        if (trace.poll.flags & POSIX_IO) {
+            trace.poll.link = trace.poll_count;
+            trace.poll.offset = trace.poll_busy;
+            trace.poll.bytes = trace.poll_bytes;
+        } else {
+            trace.poll.data = trace.poll_count;
+            trace.poll.bytes = trace.poll_busy;
+        }
+        trace.poll_count = 0;
+        append(trace, trace.poll, trace.poll_context);
+    }
+
+    // Режим trace: страницы всех потоков сливаются по времени начала.
+    // Внутри потока события записаны по завершению: регионы, функции и ряды
+    // опросов попадают в трассу позже вложенных в них событий, Init - последним.
+    // Поэтому события потока сначала упорядочиваются по началу (устойчиво),
+    // затем потоки сливаются.
+    void write_merged() {
+        _writer.write_strings(0, _names.strings());
+        struct Position {
+            uint32_t page;
+            uint32_t index;
+        };
+        struct Cursor {
+            const ThreadTrace* trace;
+            std::vector<Position> order;
+            size_t next;
+
+            const EventRecord& event(const Position& position) const {
+                return trace->pages[position.page]->events[position.index];
+            }
+        };
+        std::vector<Cursor> cursors;
+        for (const ThreadTrace* trace = _threads.load(std::memory_order_acquire); trace; trace = trace->next) {
+            Cursor cursor{trace, {}, 0};
+            for (uint32_t page = 0; page < trace->pages.size(); page++) {
+                for (uint32_t index = 0; index < trace->pages[page]->events.size(); index++) {
+                    cursor.order.push_back({page, index});
+                }
+            }
+            std::stable_sort(cursor.order.begin(), cursor.order.end(), [&](const Position& a, const Position& b) {
+                return cursor.event(a).start < cursor.event(b).start;
+            });
+            cursors.push_back(std::move(cursor));
+        }
+        while (true) {
+            const EventRecord* first = nullptr;
+            Cursor* from = nullptr;
+            for (Cursor& cursor : cursors) {
+                if (cursor.next == cursor.order.size()) continue;
+                const EventRecord& event = cursor.event(cursor.order[cursor.next]);
+                if (!first || event.start < first->start) {
+                    first = &event;
+                    from = &cursor;
+                }
+            }
+            if (!first) break;
+            const Position& position = from->order[from->next++];
+            _writer.add_event(*first, from->trace->pages[position.page]->contexts[position.index]);
+        }
+        _writer.flush_block();
+    }
+
+    // Режим profile: сумма профилей всех потоков на момент вызова и MPI_Init
+    Profile merge_profiles(double scale) const {
+        Profile total;
+        for (const ThreadTrace* trace = _threads.load(std::memory_order_acquire); trace; trace = trace->next) {
+            total.merge(*trace->profile);
+        }
+        total.record(FUNCTION_Init, static_cast<uint64_t>(_init_duration.count() / scale), 0);
+        return total;
+    }
+
+    void open_trace() {
+        std::string file_name = FolderName + "/trace_rank_" + std::to_string(_rank_process);
+        if (!_writer.open(file_name)) {
+            std::cerr << "mpitrace: can not open " << file_name << "\n";
+        }
+        _writer.write_header(_rank_process, clock_name(), tick_unit(),
+            std::chrono::duration_cast<time_metric>(_system_start.time_since_epoch()).count(),
+            _init_duration.count());
+
+        if (_mode == TraceMode::STREAM) {
+            size_t bytes = env_size("MPITRACE_BUFFER_MB", 8) << 20;
+            _stream = std::make_unique<StreamWriter>(std::move(_writer));
+            _stream->start(env_size("MPITRACE_BUFFERS", 2), bytes / sizeof(EventRecord));
+        }
+    }
+    
+public:
+    using Clock = ClockPolicy;
+
+    TraceCollector() = default;
+
+    // Горячий путь: только чтение часов, без пересчёта единиц
+    static uint64_t now() noexcept {
+        return ClockPolicy::now();
+    }
+
+    // MPI_Init измеряется отдельно по steady_clock: до PMPI_Init часы
+    // ClockPolicy могут быть недоступны (MPI_Wtime)
+    void start(int rank, std::chrono::nanoseconds init_duration) {
+        read_calibration_point(_calib_start_ticks, _calib_start_ns);
+        _start_ticks = _calib_start_ticks;
+        _init_duration = init_duration;
+        _system_start = std::chrono::system_clock::now() - std::chrono::duration_cast<
+            std::chrono::system_clock::duration>(init_duration);
+        _rank_process = rank;
+        CreateFolder();
+
+        const char* mode = std::getenv("MPITRACE_MODE");
+        if (mode && std::string(mode) == "stream") _mode = TraceMode::STREAM;
+        if (mode && std::string(mode) == "profile") _mode = TraceMode::PROFILE;
+        if (!profiling()) open_trace();
+        _modules = capture_load_map();
+        if (!profiling()) _contexts.init(_modules, reinterpret_cast<uintptr_t>(&TraceCollector::now));
+        _function_name = intern("function");
+        local();  // поток MPI_Init получает номер 0
+        _initialized.store(true, std::memory_order_release);
+    }
+
+    // Вторая точка калибровки, вызывается из MPI_Finalize до PMPI_Finalize
+    void finish() {
+        read_calibration_point(_calib_end_ticks, _calib_end_ns);
+        if (!profiling()) return;
+
+        // Сводка по рангам собирается здесь, пока MPI ещё доступен; Finalize в неё
+        // не входит, в профиль ранга он попадает при записи (close)
+        const char* reduce = std::getenv("MPITRACE_PROFILE_REDUCE");
+        if (reduce && std::string(reduce) != "0") {
+            double scale = ns_per_tick();
+            Profile total = merge_profiles(scale).reduce(MPI_COMM_WORLD);
+            if (_rank_process == 0) {
+                total.write(FolderName + "/profile_total", std::string("all ranks, clock ") + clock_name(), scale);
+            }
+        }
+    }
+
+    // Снимки стека по мере разбора колец, чтобы они не копились до записи трассы.
+    // Один вызывающий (фоновый поток разбора), до close(): в режиме trace файл
+    // до close() больше никто не пишет, в режиме stream пишет поток записи.
+    void write_samples(std::vector<StackSample>& samples) {
+        if (samples.empty() || profiling()) return;
+        AllocationScope scope;
+        if (_stream) {
+            _stream->submit_samples(samples);
+        } else {
+            _writer.write_samples(samples);
+        }
+        samples.clear();
+    }
+
+    // Каталог трассы: рядом с ней пишутся сводки
+    const std::string& folder() const {
+        return FolderName;
+    }
+
+    bool profiling() const {
+        return _mode == TraceMode::PROFILE;
+    }
+
+    // Режим profile: вместо записи события обновляется строка функции в профиле потока
+    void record(FunctionId id, uint64_t start, uint64_t end, uint64_t bytes) {
+        local().profile->record(id, end - start, bytes);
+    }
+
+    // Вызывается один раз на каждое место вызова (static в обёртке)
+    uint16_t intern(std::string_view name) {
+        AllocationScope scope;
+        std::lock_guard<std::mutex> lock(_names_mutex);
+        return _names.intern(name);
+    }
+
+    uint64_t names_dropped() {
+        std::lock_guard<std::mutex> lock(_names_mutex);
+        return _names.overflow();
+    }
+
+    static EventRecord make_event(uint16_t name) {
+        EventRecord event{};
+        event.name = name;
+        event.peer = -1;
+        event.comm = CommRegistry::NO_ID;
+        event.tag = MPI_ANY_TAG;
+        event.link = NO_LINK;
+        event.offset = NO_OFFSET;
+        return event;
+    }
+
+    // Место вызова: путь от кадра обёртки (MPITRACE_CONTEXT). Снимается только
+    // в обёртках MPI; у остальных событий (POSIX, регионы, память) его нет
+    uint32_t context(const void* frame) {
+        if (!_contexts.enabled() || !initialized()) return NO_CONTEXT;
+        AllocationScope scope;
+        return _contexts.capture(frame);
+    }
+
+    // Возвращает номер события в трассе процесса (EventRecord::id)
+    uint32_t push_back(const EventRecord& event, uint32_t context = NO_CONTEXT) {
+        ThreadTrace& trace = local();
+        if (trace.poll_count) flush_poll(trace);
+        return append(trace, event, context);
+    }
+
+    // Неудачный опрос: продлевает текущий ряд, если совпадают имя и ключ
+    // (запрос или коммуникатор с источником и тегом), иначе начинает новый.
+    // Ряд пишется одной записью POLLS перед следующим обычным событием.
+    // Мелкие чтения и записи (POSIX_IO) собираются так же, с суммой байтов.
+    void push_poll(const EventRecord& event, uint64_t key, uint32_t context = NO_CONTEXT) {
+        ThreadTrace& trace = local();
+        if (trace.poll_count && (key != trace.poll_key || event.name != trace.poll.name)) flush_poll(trace);
+        if (!trace.poll_count) {
+            trace.poll = event;
+            trace.poll_context = context;
+            // Прочие значения флагов теряют смысл у ряда
+            trace.poll.flags = POLLS | (event.flags & (POSIX_IO | OPENMP));
+            trace.poll.offset = NO_OFFSET;
+            trace.poll_key = key;
+            trace.poll_busy = 0;
+            trace.poll_bytes = 0;
+        }
+        trace.poll.end = event.end;
+        trace.poll_busy += event.end - event.start;
+        trace.poll_bytes += event.bytes;
+        trace.poll_count++;
+    }
+
+    // Вход не пишет событие, только запоминает время. До MPI_Init, после
+    // записи трассы и в режиме profile регионы не записываются.
+    void open_region(uint16_t name, uint64_t address) {
+        RecordingScope scope(*this);
+        if (!scope || profiling()) return;
+        uint64_t start = now();
+        ThreadTrace& trace = local();
+        if (trace.depth < ThreadTrace::MAX_REGIONS) trace.regions[trace.depth] = {name, address, start};
+        trace.depth++;
+    }
+
+    // Непарный выход закрывает и все вложенные регионы тем же временем
+    // (у функций - кадры, пропущенные исключением или longjmp);
+    // выход из неоткрытого региона пропускается
+    void leave_region(uint16_t name, uint64_t address) {
+        RecordingScope scope(*this);
+        if (!scope || profiling()) return;
+        uint64_t end = now();
+        ThreadTrace& trace = local();
+        if (trace.depth > ThreadTrace::MAX_REGIONS) {
+            trace.depth--;
+            return;
+        }
+        uint32_t depth = trace.depth;
+        while (depth && (trace.regions[depth - 1].name != name || trace.regions[depth - 1].address != address)) depth--;
+        if (!depth) return;
+        while (trace.depth >= depth) close_region(trace, end);
+    }
+
+    // Пользовательские регионы (pt_region.h)
+    void enter_region(uint16_t name) {
+        open_region(name, 0);
+    }
+
+    void exit_region(uint16_t name) {
+        leave_region(name, 0);
+    }
+
+    // Функции -finstrument-functions: адрес пишется как есть, имя
+    // восстанавливается после запуска по карте загрузки (modules())
+    void enter_function(uint64_t address) {
+        open_region(_function_name, address);
+    }
+
+    void exit_function(uint64_t address) {
+        leave_region(_function_name, address);
+    }
+
+    // До start(): поток MPI_Init регистрируется в нём
+    void set_thread_hook(ThreadHook hook) {
+        _thread_hook = hook;
+    }
+
+    const std::vector<ModuleDefinition>& modules() const {
+        return _modules;
+    }
+
+    bool initialized() const {
+        return _initialized.load(std::memory_order_acquire);
+    }
+
+    static bool allocating() {
+        return _allocating;
+    }
+
+    // Между MPI_Init и записью трассы: вызовы вне MPI (POSIX) пишутся только здесь
+    bool recording() const {
+        return initialized() && !_closed.load(std::memory_order_acquire);
+    }
+
+    // Запись события вне вызова MPI. Поток сначала отмечает себя пишущим
+    // в своём ThreadTrace, потом проверяет _closed; close() делает наоборот и
+    // ждёт отметки каждого потока, так что чужие буферы он трогает только
+    // после них. Отметка в строке кэша потока: потоки не делят счётчик.
+    class RecordingScope {
+    private:
+        ThreadTrace* _trace = nullptr;
+        bool _active = false;
+
+    public:
+        explicit RecordingScope(TraceCollector& collector) {
+            if (!collector.recording()) return;
+            _trace = &collector.local();
+            _trace->active.store(_trace->active.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+            _active = !collector._closed.load(std::memory_order_seq_cst);
+        }
+        ~RecordingScope() {
+            if (_trace) _trace->active.store(_trace->active.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+        }
+        RecordingScope(const RecordingScope&) = delete;
+        RecordingScope& operator=(const RecordingScope&) = delete;
+
+        explicit operator bool() const {
+            return _active;
+        }
+    };
+
+    // Тики читаются между двумя чтениями опорных часов, берётся середина
+    static void read_calibration_point(uint64_t& ticks, uint64_t& ns) {
+        uint64_t before = monotonic_ns();
+        ticks = ClockPolicy::now();
+        uint64_t after = monotonic_ns();
+        ns = before + (after - before) / 2;
+    }
+
+    // Для часов без фиксированной частоты (rdtscp) - по двум точкам калибровки;
+    // если MPI_Finalize не был вызван, вторая точка берётся в момент записи
+    double ns_per_tick() const {
+        if constexpr (ClockPolicy::calibrated) {
+            if (!ClockPolicy::active()) return 1.0;
+            uint64_t end_ticks = _calib_end_ticks, end_ns = _calib_end_ns;
+            if (!end_ticks) read_calibration_point(end_ticks, end_ns);
+            uint64_t ticks = end_ticks - _calib_start_ticks;
+            return ticks ? static_cast<double>(end_ns - _calib_start_ns) / ticks : 1.0;
+        } else {
+            return ClockPolicy::ns_per_tick;
+        }
+    }
+
+    static const char* clock_name() {
+        if constexpr (ClockPolicy::calibrated) {
+            if (!ClockPolicy::active()) return ClockPolicy::fallback_name;
+        }
+        return ClockPolicy::name;
+    }
+
+    static const char* tick_unit() {
+        if constexpr (ClockPolicy::calibrated) {
+            if (ClockPolicy::active()) return "ticks";
+        }
+        return "ns";
+    }
+
+    // Внутри библиотеки вызываем только PMPI_*, чтобы не трассировать самих себя
+    void CreateFolder(){
+        FolderName = "Traces";
+        int count = 1;
+        if (!_rank_process){
+            while (true){
+                std::string temp_name = FolderName + std::to_string(count);
+                if (!std::filesystem::exists(temp_name)){
+                    std::filesystem::create_directory(temp_name);
+                    break;
+                }
+                else{
+                    count++;
+                }
+            }
+        }
+        PMPI_Bcast(&count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        FolderName += std::to_string(count);
+    }
+
+    void CreateMetaFile(std::string FolderName){
+        std::string file_name = FolderName + "/meta_file";
+        std::ofstream file(file_name);
+
+        file << "mpitrace binary v" << TRACE_VERSION << "\n";
+        file << clock_name() << "\n";
+
+        file.close();
+    }
+
+    // Дописывает оставшиеся события и снимки, состав коммуникаторов и калибровку часов.
+    // В режиме stream это только последние, частично заполненные буферы потоков.
+    // Другие потоки к этому моменту уже не вызывают MPI (после MPI_Finalize),
+    // а записи вне MPI, начатые до закрытия, дожидаются (RecordingScope).
+    // Из деструктора comms не передаётся: реестр к тому моменту может быть разрушен.
+    void close(const std::vector<CommDefinition>& comms = {}, const std::vector<StackSample>& samples = {}) {
+        if (!initialized() || _closed.exchange(true, std::memory_order_seq_cst)) return;
+        for (ThreadTrace* trace = _threads.load(std::memory_order_seq_cst); trace; trace = trace->next) {
+            while (trace->active.load(std::memory_order_seq_cst)) std::this_thread::yield();
+        }
+
+        if (profiling()) {
+            double scale = ns_per_tick();
+            merge_profiles(scale).write(FolderName + "/profile_rank_" + std::to_string(_rank_process),
+                "rank " + std::to_string(_rank_process) + ", clock " + clock_name(), scale);
+            return;
+        }
+
+        // MPI_Init: до PMPI_Init часов ещё нет, событие восстанавливается по длительности
+        double scale = ns_per_tick();
+        EventRecord init = make_event(intern("Init"));
+        init.start = _start_ticks - static_cast<uint64_t>(_init_duration.count() / scale);
+        init.end = _start_ticks;
+        // Регионы, открытые на момент записи, закрываются ею
+        uint64_t end = now();
+        ThreadTrace* threads = _threads.load(std::memory_order_acquire);
+        for (ThreadTrace* trace = threads; trace; trace = trace->next) {
+            trace->depth = std::min(trace->depth, ThreadTrace::MAX_REGIONS);
+            while (trace->depth) close_region(*trace, end);
+            if (trace->poll_count) flush_poll(*trace);
+        }
+        append(local(), init);
+
+        if (_stream) {
+            for (ThreadTrace* trace = threads; trace; trace = trace->next) {
+                attach_names(*trace->current);
+                _stream->submit(*trace->channel, trace->current);
+            }
+            _stream->finish();
+        } else {
+            write_merged();
+            _written = true;
+        }
+        writer().write_comms(comms);
+        writer().write_modules(_modules);
+        writer().write_samples(samples);
+        writer().write_contexts(_contexts.nodes());
+        writer().write_clock(_start_ticks, scale);
+        writer().close();
+
+        if (_rank_process == 0){
+            CreateMetaFile(FolderName);
+        }
+    }
+
+    ~TraceCollector() {
+        // Библиотека может быть подгружена в процесс без MPI (mpirun, orted)
+        close();
+        ThreadTrace* trace = _threads.exchange(nullptr);
+        while (trace) {
+            ThreadTrace* next = trace->next;
+            delete trace;
+            trace = next;
+        }
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <mpi.h>
+#include "last_hit.h"
+
+// Размеры типов данных: MPI_Type_size вызывается один раз на тип.
+// Освобождённый тип удаляется (MPI_Type_free), так как его дескриптор
+// может быть выдан заново для другого типа.
+class TypeSizeCache {
+private:
+    std::unordered_map<MPI_Datatype, int> _sizes;
+    std::shared_mutex _mutex;
+
+    // Последний тип потока: обмены подряд обычно одного типа
+    LastHit<TypeSizeCache, MPI_Datatype, int> _last;
+
+public:
+    int size(MPI_Datatype type) {
+        if (type == MPI_DATATYPE_NULL) return 0;
+        int size = 0;
+        if (_last.find(type, size)) return size;
+        uint64_t generation = _last.generation();
+        bool found;
+        {
+            std::shared_lock lock(_mutex);
+            auto it = _sizes.find(type);
+            found = it != _sizes.end();
+            if (found) size = it->second;
+        }
+        if (!found) {
+            PMPI_Type_size(type, &size);
+            std::unique_lock lock(_mutex);
+            _sizes.emplace(type, size);
+        }
+        _last.remember(type, size, generation);
+        return size;
+    }
+
+    void remove(MPI_Datatype type) {
+        std::unique_lock lock(_mutex);
+        _last.invalidate();
+        _sizes.erase(type);
+    }
+};
@@ -0,0 +1,148 @@
+#pragma once
+#include <mpi.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "comm_registry.h"
+#include "trace_format.h"
+
+// Действие синхронизации окна: как вызов открывает или закрывает эпоху
+enum class EpochAction {
+    SYNC,        // операция или flush внутри эпохи, состояние не меняется
+    FENCE,       // закрывает эпоху предыдущего fence и открывает следующую
+    LOCK,        // пассивная эпоха доступа к одному процессу
+    UNLOCK,
+    LOCK_ALL,
+    UNLOCK_ALL,
+    START,       // PSCW: эпоха доступа
+    COMPLETE,
+    POST,        // PSCW: эпоха предоставления доступа
+    WAIT,
+};
+
+// Окно и его открытые эпохи. Эпоха задаётся номером события, которое
+// её открыло: операции и закрывающий вызов ссылаются на него (link),
+// так время в MPI_Win_fence относится к закрываемой эпохе. Эпохи одного
+// окна могут менять несколько потоков (MPI_THREAD_MULTIPLE) - под mutex.
+struct WinInfo {
+    uint32_t id;
+    uint32_t comm;                  // идентификатор коммуникатора окна в CommRegistry
+    std::vector<int> world_ranks;   // ранг в группе окна -> ранг в MPI_COMM_WORLD
+
+    uint32_t fence = NO_LINK;
+    uint32_t access = NO_LINK;      // Win_start
+    uint32_t exposure = NO_LINK;    // Win_post
+    uint32_t lock_all = NO_LINK;
+    std::unordered_map<int, uint32_t> locks;  // целевой ранг -> Win_lock
+    uint32_t collectives = 0;       // номер следующего Win_fence на окне
+    mutable std::mutex mutex;
+
+    int to_world(int rank) const {
+        return rank >= 0 && rank < static_cast<int>(world_ranks.size()) ? world_ranks[rank] : rank;
+    }
+
+    // Эпоха доступа, в которой идёт операция с target; под mutex
+    uint32_t epoch(int target) const {
+        auto it = locks.find(target);
+        if (it != locks.end()) return it->second;
+        if (lock_all != NO_LINK) return lock_all;
+        if (access != NO_LINK) return access;
+        return fence;
+    }
+
+    // Эпоха, которую закрывает вызов (до вызова)
+    uint32_t closes(EpochAction action, int target) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        switch (action) {
+        case EpochAction::SYNC:       return epoch(target);
+        case EpochAction::FENCE:      return fence;
+        case EpochAction::UNLOCK:     return epoch(target);
+        case EpochAction::UNLOCK_ALL: return lock_all;
+        case EpochAction::COMPLETE:   return access;
+        case EpochAction::WAIT:       return exposure;
+        default:                      return NO_LINK;
+        }
+    }
+
+    // Состояние после успешного вызова; index - номер его события
+    void apply(EpochAction action, int target, uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        switch (action) {
+        case EpochAction::FENCE:      fence = index; break;
+        case EpochAction::LOCK:       locks[target] = index; break;
+        case EpochAction::UNLOCK:     locks.erase(target); break;
+        case EpochAction::LOCK_ALL:   lock_all = index; break;
+        case EpochAction::UNLOCK_ALL: lock_all = NO_LINK; break;
+        case EpochAction::START:      access = index; break;
+        case EpochAction::COMPLETE:   access = NO_LINK; break;
+        case EpochAction::POST:       exposure = index; break;
+        case EpochAction::WAIT:       exposure = NO_LINK; break;
+        case EpochAction::SYNC:       break;
+        }
+    }
+};
+
+// Реестр окон RMA, ключ - дескриптор MPI_Win. Идентификатор согласуется
+// так же, как у коммуникаторов (IdAgreement по коммуникатору окна).
+// Блокировки - как в CommRegistry, только при промахе кэша последнего окна.
+class WinRegistry {
+private:
+    std::unordered_map<MPI_Win, WinInfo> _wins;
+    IdAgreement _ids;
+    std::atomic<uint32_t> _next_local_id{0};
+    std::shared_mutex _mutex;
+
+    LastHit<WinRegistry, MPI_Win, WinInfo*> _last;
+
+    // Под исключительной блокировкой. WinInfo не копируется (mutex):
+    // запись с тем же дескриптором создаётся заново
+    WinInfo& insert(MPI_Win win, uint32_t id, uint32_t comm) {
+        if (_wins.erase(win)) _last.invalidate();
+        WinInfo& info = _wins[win];
+        info.id = id;
+        info.comm = comm;
+        MPI_Group group;
+        PMPI_Win_get_group(win, &group);
+        info.world_ranks = translate_to_world(group);
+        PMPI_Group_free(&group);
+        return info;
+    }
+
+public:
+    // Коллективная операция над comm (создание окна тоже коллективное)
+    void add(MPI_Win win, MPI_Comm comm, uint32_t comm_id) {
+        if (win == MPI_WIN_NULL) return;
+        uint32_t id = _ids.agree(comm);
+        std::unique_lock lock(_mutex);
+        insert(win, id, comm_id);
+    }
+
+    void remove(MPI_Win win) {
+        std::unique_lock lock(_mutex);
+        _last.invalidate();
+        _wins.erase(win);
+    }
+
+    WinInfo& get(MPI_Win win) {
+        WinInfo* info;
+        if (_last.find(win, info)) return *info;
+        uint64_t generation = _last.generation();
+        {
+            std::shared_lock lock(_mutex);
+            auto it = _wins.find(win);
+            info = it != _wins.end() ? &it->second : nullptr;
+        }
+        if (!info) {
+            std::unique_lock lock(_mutex);
+            auto it = _wins.find(win);
+            info = it != _wins.end() ? &it->second
+                                     : &insert(win, CommRegistry::LOCAL_ID | _next_local_id.fetch_add(1, std::memory_order_relaxed),
+                                               CommRegistry::NO_ID);
+        }
+        _last.remember(win, info, generation);
+        return *info;
+    }
+};
@@ -0,0 +1,78 @@
+#include "collective_match.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+struct InstanceKey {
+    uint32_t comm;
+    int32_t leader;
+    uint64_t object;
+    uint32_t sequence;
+
+    bool operator==(const InstanceKey& other) const {
+        return comm == other.comm && leader == other.leader && object == other.object && sequence == other.sequence;
+    }
+};
+
+struct InstanceKeyHash {
+    size_t operator()(const InstanceKey& key) const {
+        uint64_t value = (uint64_t(key.comm) << 32 | key.sequence) ^ (uint64_t(uint32_t(key.leader)) * 0x9E3779B97F4A7C15ull) ^
+                         (key.object * 0xC2B2AE3D27D4EB4Full);
+        return std::hash<uint64_t>{}(value);
+    }
+};
+
+// Файл и окно нумеруют свои коллективы отдельно от коммуникатора
+uint64_t instance_object(const EventRecord& event) {
+    if (event.flags & FILE_IO) return uint64_t(1) << 32 | event.data;
+    if (event.flags & WINDOW) return uint64_t(2) << 32 | event.data;
+    return 0;
+}
+
+}  // namespace
+
+std::vector<CollectiveInstance> match_collectives(const std::vector<TraceReader>& traces) {
+    uint64_t origin_us = UINT64_MAX;
+    for (const TraceReader& trace : traces) origin_us = std::min(origin_us, trace.system_start_us);
+
+    std::vector<CollectiveInstance> instances;
+    std::unordered_map<InstanceKey, size_t, InstanceKeyHash> index;
+    for (size_t rank = 0; rank < traces.size(); rank++) {
+        const TraceReader& trace = traces[rank];
+        int64_t offset = static_cast<int64_t>(trace.system_start_us - origin_us) * 1000;
+        for (size_t i = 0; i < trace.events.size(); i++) {
+            const EventRecord& event = trace.events[i];
+            if (!(event.flags & INSTANCE)) continue;
+            const std::vector<int32_t>* members = trace.members(event.comm);
+            if (!members || members->empty()) continue;
+
+            InstanceKey key{event.comm, (*members)[0], instance_object(event), event.link};
+            auto [it, inserted] = index.try_emplace(key, instances.size());
+            if (inserted) {
+                CollectiveInstance instance;
+                instance.comm = event.comm;
+                instance.sequence = event.link;
+                instance.name = trace.name(event);
+                instance.size = members->size();
+                instances.push_back(std::move(instance));
+            }
+            CollectiveInstance& instance = instances[it->second];
+            int64_t entry = offset + trace.to_ns(event.start);
+            int64_t exit = offset + trace.to_ns(event.end);
+            instance.members.push_back({static_cast<int>(rank), i, entry, exit});
+            instance.first_entry = std::min(instance.first_entry, entry);
+            instance.last_entry = std::max(instance.last_entry, entry);
+            instance.first_exit = std::min(instance.first_exit, exit);
+            instance.last_exit = std::max(instance.last_exit, exit);
+        }
+    }
+
+    // Ожидание опоздавшего: последний вход известен только после всех трасс
+    for (CollectiveInstance& instance : instances) {
+        for (const CollectiveInstance::Member& member : instance.members) {
+            instance.wait += instance.last_entry - member.entry;
+        }
+    }
+    return instances;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "trace_reader.h"
+
+// Экземпляр коллектива: одни и те же (коммуникатор, номер вызова) на всех
+// участниках. Времена - нс на общей шкале (от самого раннего SYSTEM_START).
+struct CollectiveInstance {
+    struct Member {
+        int rank;       // индекс трассы
+        size_t event;   // номер события в TraceReader::events
+        int64_t entry;
+        int64_t exit;
+    };
+
+    uint32_t comm;
+    uint32_t sequence;
+    std::string name;
+    size_t size;                  // число участников по секции COMMS
+    std::vector<Member> members;  // в порядке трасс
+
+    int64_t first_entry = INT64_MAX;
+    int64_t last_entry = INT64_MIN;
+    int64_t first_exit = INT64_MAX;
+    int64_t last_exit = INT64_MIN;
+    int64_t wait = 0;             // сумма по участникам: last_entry - entry
+
+    bool complete() const {
+        return members.size() == size;
+    }
+
+    int64_t entry_skew() const {
+        return last_entry - first_entry;
+    }
+
+    int64_t exit_skew() const {
+        return last_exit - first_exit;
+    }
+};
+
+// Сопоставление событий INSTANCE всех трасс за один проход: ключ -
+// (идентификатор коммуникатора, первый ранг группы, файл или окно, номер вызова).
+// traces[i] - трасса ранга i; коммуникаторы без записи в COMMS пропускаются.
+std::vector<CollectiveInstance> match_collectives(const std::vector<TraceReader>& traces);
@@ -0,0 +1,43 @@
+#include "sample_attribution.h"
+#include <algorithm>
+#include <unordered_map>
+
+// Проход по времени отдельно в каждом потоке: события по началу, снимки по
+// времени; открытые события хранятся в порядке начала, завершившиеся
+// убираются при очередном снимке. Вложенность мала, поэтому проход линейный.
+std::vector<SampleOwner> attribute_samples(const TraceReader& trace) {
+    std::vector<SampleOwner> owners(trace.samples.size());
+    std::unordered_map<uint32_t, std::vector<size_t>> events_of;
+    std::unordered_map<uint32_t, std::vector<size_t>> samples_of;
+    for (size_t i = 0; i < trace.events.size(); i++) {
+        if (trace.events[i].flags & (COMPLETION | COUNTER)) continue;
+        events_of[trace.events[i].thread].push_back(i);
+    }
+    for (size_t i = 0; i < trace.samples.size(); i++) samples_of[trace.samples[i].thread].push_back(i);
+
+    for (auto& [thread, samples] : samples_of) {
+        std::vector<size_t>& events = events_of[thread];
+        std::sort(events.begin(), events.end(), [&](size_t a, size_t b) {
+            return trace.events[a].start < trace.events[b].start;
+        });
+        std::sort(samples.begin(), samples.end(), [&](size_t a, size_t b) {
+            return trace.samples[a].time < trace.samples[b].time;
+        });
+        std::vector<size_t> open;
+        size_t next = 0;
+        size_t last_ended = NO_EVENT;
+        for (size_t sample : samples) {
+            uint64_t time = trace.samples[sample].time;
+            while (next < events.size() && trace.events[events[next]].start <= time) open.push_back(events[next++]);
+            auto ended = std::remove_if(open.begin(), open.end(), [&](size_t event) {
+                if (trace.events[event].end >= time) return false;
+                if (last_ended == NO_EVENT || trace.events[event].end > trace.events[last_ended].end) last_ended = event;
+                return true;
+            });
+            open.erase(ended, open.end());
+            owners[sample].inside = open.empty() ? NO_EVENT : open.back();
+            owners[sample].after = last_ended;
+        }
+    }
+    return owners;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "trace_reader.h"
+
+constexpr size_t NO_EVENT = static_cast<size_t>(-1);
+
+// Событие, к которому относится снимок стека (номера в TraceReader::events).
+// inside - самое внутреннее событие потока, идущее во время снимка (вызов MPI
+// или регион); after - последнее завершившееся до снимка событие потока:
+// промежуток счёта после него. Завершения (COMPLETION) и показания (COUNTER)
+// не учитываются.
+struct SampleOwner {
+    size_t inside = NO_EVENT;
+    size_t after = NO_EVENT;
+};
+
+// Результат в порядке TraceReader::samples
+std::vector<SampleOwner> attribute_samples(const TraceReader& trace);
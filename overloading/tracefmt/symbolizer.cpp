@@ -0,0 +1,122 @@
+#include "symbolizer.h"
+#include <cxxabi.h>
+#include <elf.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+std::string demangle(const char* name) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status != 0 || !demangled) return name;
+    std::string result(demangled);
+    std::free(demangled);
+    return result;
+}
+
+std::string hex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    do {
+        out.insert(out.begin(), digits[value & 0xF]);
+        value >>= 4;
+    } while (value);
+    return "0x" + out;
+}
+
+}  // namespace
+
+bool ElfSymbols::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Elf64_Ehdr header;
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0 || header.e_ident[EI_CLASS] != ELFCLASS64) return false;
+    if (header.e_shentsize != sizeof(Elf64_Shdr) ||
+        header.e_shoff + uint64_t(header.e_shnum) * sizeof(Elf64_Shdr) > data.size()) return false;
+
+    std::vector<Elf64_Shdr> sections(header.e_shnum);
+    std::memcpy(sections.data(), data.data() + header.e_shoff, sections.size() * sizeof(Elf64_Shdr));
+
+    // После strip остаётся только динамическая таблица
+    const Elf64_Shdr* table = nullptr;
+    for (const Elf64_Shdr& section : sections) {
+        if (section.sh_type == SHT_SYMTAB) table = &section;
+    }
+    if (!table) {
+        for (const Elf64_Shdr& section : sections) {
+            if (section.sh_type == SHT_DYNSYM) table = &section;
+        }
+    }
+    if (!table || table->sh_link >= sections.size()) return false;
+    const Elf64_Shdr& strings = sections[table->sh_link];
+    if (table->sh_offset + table->sh_size > data.size() || strings.sh_offset + strings.sh_size > data.size()) return false;
+
+    size_t count = table->sh_size / sizeof(Elf64_Sym);
+    for (size_t i = 0; i < count; i++) {
+        Elf64_Sym symbol;
+        std::memcpy(&symbol, data.data() + table->sh_offset + i * sizeof(Elf64_Sym), sizeof(symbol));
+        if (ELF64_ST_TYPE(symbol.st_info) != STT_FUNC || symbol.st_value == 0) continue;
+        if (symbol.st_name >= strings.sh_size) continue;
+        const char* name = data.data() + strings.sh_offset + symbol.st_name;
+        _symbols.push_back({symbol.st_value, symbol.st_size, demangle(name)});
+    }
+    std::sort(_symbols.begin(), _symbols.end(), [](const Symbol& a, const Symbol& b) {
+        return a.address < b.address;
+    });
+    return true;
+}
+
+const std::string* ElfSymbols::find(uint64_t address) const {
+    auto it = std::upper_bound(_symbols.begin(), _symbols.end(), address, [](uint64_t value, const Symbol& symbol) {
+        return value < symbol.address;
+    });
+    if (it == _symbols.begin()) return nullptr;
+    --it;
+    // Размер 0 у ассемблерных функций: адрес должен совпасть точно
+    if (address >= it->address + std::max<uint64_t>(it->size, 1)) return nullptr;
+    return &it->name;
+}
+
+Symbolizer::Symbolizer(std::vector<ModuleDefinition> modules)
+    : _modules(std::move(modules)), _symbols(_modules.size()), _loaded(_modules.size(), false) {}
+
+const ModuleDefinition* Symbolizer::module_of(uint64_t address, const ElfSymbols** symbols) {
+    for (size_t i = 0; i < _modules.size(); i++) {
+        if (address < _modules[i].low || address >= _modules[i].high) continue;
+        if (!_loaded[i]) {
+            _loaded[i] = true;
+            auto loaded = std::make_unique<ElfSymbols>();
+            if (loaded->load(_modules[i].path)) _symbols[i] = std::move(loaded);
+        }
+        *symbols = _symbols[i].get();
+        return &_modules[i];
+    }
+    *symbols = nullptr;
+    return nullptr;
+}
+
+std::string Symbolizer::function(uint64_t address) {
+    const ElfSymbols* symbols;
+    const ModuleDefinition* module = module_of(address, &symbols);
+    const std::string* name = module && symbols ? symbols->find(address - module->base) : nullptr;
+    return name ? *name : std::string();
+}
+
+std::string Symbolizer::resolve(uint64_t address) {
+    const ElfSymbols* symbols;
+    const ModuleDefinition* module = module_of(address, &symbols);
+    if (!module) return hex(address);
+    if (symbols) {
+        if (const std::string* name = symbols->find(address - module->base)) return *name;
+    }
+    size_t slash = module->path.rfind('/');
+    return module->path.substr(slash == std::string::npos ? 0 : slash + 1) + "+" + hex(address - module->base);
+}
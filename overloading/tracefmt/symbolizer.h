@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "trace_format.h"
+
+// Функции одного ELF-файла (64 бит) из .symtab, без неё - из .dynsym.
+// Имена C++ хранятся в раскрытом виде (abi::__cxa_demangle).
+class ElfSymbols {
+public:
+    bool load(const std::string& path);
+
+    // Функция, содержащая адрес (адрес в файле, без смещения загрузки); nullptr - нет такой
+    const std::string* find(uint64_t address) const;
+
+private:
+    struct Symbol {
+        uint64_t address;
+        uint64_t size;
+        std::string name;
+    };
+    std::vector<Symbol> _symbols;  // по возрастанию адреса
+};
+
+// Адрес процесса -> имя функции по карте загрузки (секция MODULES).
+// Символы модуля читаются при первом адресе из него.
+class Symbolizer {
+public:
+    explicit Symbolizer(std::vector<ModuleDefinition> modules);
+
+    // Имя функции; без символа - "модуль+0xсмещение", вне модулей - "0xадрес"
+    std::string resolve(uint64_t address);
+
+    // Только имя из таблицы символов; пустая строка, если его нет
+    std::string function(uint64_t address);
+
+private:
+    std::vector<ModuleDefinition> _modules;
+    std::vector<std::unique_ptr<ElfSymbols>> _symbols;  // nullptr - файл не прочитан
+    std::vector<bool> _loaded;                          // чтение уже пробовали
+
+    const ModuleDefinition* module_of(uint64_t address, const ElfSymbols** symbols);
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Бинарный формат трассы одного процесса (trace_rank_N).
+//
+// Файл: MAGIC, затем последовательность секций
+//   [u8 тип][varint длина][данные]
+// Неизвестные секции читатель пропускает по длине.
+//
+// HEADER      varint версия, varint ранг, string часы, string единица тиков,
+//             varint SYSTEM_START (мкс от эпохи), varint длительность MPI_Init (нс)
+// STRINGS     varint первый индекс, varint количество, string...
+// EVENTS      блок событий: varint количество, varint min start, varint max end,
+//             затем для каждого события:
+//               zigzag(start - предыдущий start; для первого - от min start),
+//               varint(end - start), varint name, varint flags,
+//               zigzag peer, varint(comm + 1, "нет" = 0), varint data,
+//               zigzag tag, varint(link + 1, "нет" = 0), varint bytes,
+//               varint(offset + 1, "нет" = 0),
+//               zigzag(id - предыдущий id - 1; для первого - от -1), varint thread,
+//               varint(узел дерева вызовов + 1, "нет" = 0)
+// CLOCK       varint тики начала отсчёта, f64 нс на тик (пишется последней)
+// COMMS       коммуникаторы процесса: varint количество, затем для каждого
+//             varint id, varint размер, varint ранги в MPI_COMM_WORLD
+// MODULES     карта загрузки на MPI_Init: varint количество, затем для каждого
+//             string путь, varint смещение загрузки, varint начало, varint конец
+// SAMPLES     снимки стека: varint количество, затем для каждого varint время,
+//             varint поток, varint глубина, varint адреса от прерванного
+// CONTEXTS    дерево вызовов ранга (пишется один раз): varint количество, затем
+//             для каждого узла varint(родитель + 1, корень = 0), varint адрес
+//
+// varint - беззнаковый LEB128, zigzag - знаковое число в varint,
+// string - varint длина и байты.
+
+constexpr char TRACE_MAGIC[8] = {'M', 'P', 'I', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t TRACE_VERSION = 7;
+
+enum class SectionType : uint8_t {
+    HEADER = 1,
+    STRINGS = 2,
+    EVENTS = 3,
+    CLOCK = 4,
+    COMMS = 5,
+    MODULES = 6,
+    SAMPLES = 7,
+    CONTEXTS = 8,
+};
+
+// Запись события фиксированного размера: без строк и векторов,
+// копируется memcpy и кодируется в блок EVENTS без преобразований
+struct EventRecord {
+    uint64_t start;    // тики ClockPolicy
+    uint64_t end;
+    uint16_t name;     // индекс в таблице строк
+    uint16_t flags;    // EventFlags
+    int32_t  peer;     // ранг партнёра в MPI_COMM_WORLD (у коллектива - корень), -1 - нет
+    uint32_t comm;     // идентификатор коммуникатора, 0xFFFFFFFF - нет
+    uint32_t data;     // смысл задают флаги: POLLS, WINDOW, FILE_IO
+    int32_t  tag;      // тег сообщения, -1 (MPI_ANY_TAG) - нет
+    uint32_t link;     // при COMPLETION - id события, начавшего операцию; при WINDOW - эпохи;
+                       // при INSTANCE - порядковый номер коллектива на comm (файле, окне)
+    uint64_t bytes;    // объём данных: count * размер типа (для приёма - фактический)
+    uint64_t offset;   // при FILE_IO - смещение в файле (байты), NO_OFFSET - нет
+    uint32_t id;       // номер события в процессе: уникален, растёт внутри потока
+    uint32_t thread;   // поток процесса в порядке первого события (0 - первый)
+};
+
+constexpr uint32_t NO_LINK = 0xFFFFFFFFu;
+constexpr uint64_t NO_OFFSET = 0xFFFFFFFFFFFFFFFFull;
+constexpr uint32_t NO_CONTEXT = 0xFFFFFFFFu;
+
+static_assert(sizeof(EventRecord) == 64, "EventRecord must stay one cache line");
+static_assert(std::is_trivially_copyable_v<EventRecord>, "EventRecord must be POD");
+
+enum EventFlags : uint16_t {
+                            // 1 << 0 - список участников до версии 5, теперь секция COMMS
+    COMPLETION   = 1 << 1,  // завершение неблокирующей операции (Wait*/Test*), start == end
+    POLLS        = 1 << 2,  // ряд неудачных опросов: start первого, end последнего,
+                            // data - число вызовов, bytes - время внутри вызовов (тики)
+    WINDOW       = 1 << 3,  // вызов над окном RMA: data - идентификатор окна,
+                            // link - событие, открывшее эпоху (операции и закрытие эпохи),
+                            // у Win_fence - номер INSTANCE
+    FILE_IO      = 1 << 4,  // вызов MPI-IO: data - идентификатор файла, offset - смещение
+    COLLECTIVE   = 1 << 5,  // коллективный вызов MPI-IO (*_all, *_ordered)
+    INSTANCE     = 1 << 6,  // коллектив на comm: link - номер вызова на этом коммуникаторе,
+                            // одинаковый у всех участников; состав - в секции COMMS.
+                            // Вместе с FILE_IO или WINDOW - номер на файле или окне data
+    REGION       = 1 << 7,  // пользовательский регион (pt_region.h): data - глубина
+                            // вложенности в потоке, запись делается на выходе
+    FUNCTION     = 1 << 8,  // вместе с REGION: функция (-finstrument-functions),
+                            // offset - её адрес в процессе, имя - по MODULES (symbolizer.h)
+    POSIX_IO     = 1 << 9,  // open/read/write/... вне MPI: data - дескриптор, offset - смещение
+                            // pread/pwrite; вместе с POLLS - ряд мелких чтений или записей:
+                            // link - число вызовов, offset - время в вызовах (тики)
+    HEAP         = 1 << 10, // крупное выделение памяти: bytes - размер, offset - адрес блока
+    COUNTER      = 1 << 11, // показание счётчиков памяти ранга (start = end): bytes - занято,
+                            // offset - максимум по показаниям, data - выделений с предыдущего
+    OPENMP       = 1 << 12, // конструкция OpenMP (OMPT): data - размер команды или число итераций,
+                            // offset - адрес конструкции; вместе с POLLS - ряд задач потока
+};
+
+// Состав коммуникатора из секции COMMS. Идентификатор различает
+// коммуникаторы с общим процессом; у непересекающихся он может совпасть,
+// поэтому экземпляр коллектива определяется ещё и первым рангом группы.
+struct CommDefinition {
+    uint32_t id;
+    std::vector<int32_t> ranks;  // ранг в коммуникаторе -> ранг в MPI_COMM_WORLD
+};
+
+// Загруженный объект процесса: адрес в нём минус base - адрес в ELF-файле
+struct ModuleDefinition {
+    std::string path;
+    uint64_t base;
+    uint64_t low;    // диапазон адресов сегментов PT_LOAD
+    uint64_t high;
+};
+
+// Снимок стека по сигналу (MPITRACE_SAMPLE_US): frames[0] - прерванная
+// инструкция, дальше адреса возврата минус 1 (внутри вызывающей функции)
+struct StackSample {
+    uint64_t time;    // тики ClockPolicy
+    uint32_t thread;  // как EventRecord::thread
+    std::vector<uint64_t> frames;
+};
+
+// Узел дерева вызовов (MPITRACE_CONTEXT): путь события - цепочка родителей
+// от узла события до корня. Номер узла - индекс в секции CONTEXTS,
+// родитель всегда записан раньше потомка.
+struct ContextNode {
+    uint32_t parent;   // NO_CONTEXT у корня
+    uint64_t address;  // адрес возврата минус 1 (внутри вызывающей функции)
+};
+
+inline void put_varint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline void put_zigzag(std::string& out, int64_t value) {
+    put_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+inline void put_string(std::string& out, std::string_view str) {
+    put_varint(out, str.size());
+    out.append(str);
+}
+
+// Чтение из буфера; при выходе за границу ok становится false
+struct ByteReader {
+    const uint8_t* pos;
+    const uint8_t* end;
+    bool ok = true;
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos == end) { ok = false; return 0; }
+            uint8_t byte = *pos++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return value;
+    }
+
+    int64_t zigzag() {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string string() {
+        uint64_t size = varint();
+        if (static_cast<uint64_t>(end - pos) < size) { ok = false; return {}; }
+        std::string str(reinterpret_cast<const char*>(pos), size);
+        pos += size;
+        return str;
+    }
+
+    template <class T>
+    T raw() {
+        T value{};
+        if (static_cast<size_t>(end - pos) < sizeof(T)) { ok = false; return value; }
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+};
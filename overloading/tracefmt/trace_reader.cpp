@@ -0,0 +1,189 @@
+#include "trace_reader.h"
+#include <fstream>
+#include <iterator>
+
+bool TraceReader::open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        _error = "can not open file " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(TRACE_MAGIC) || std::memcmp(data.data(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        _error = path + " is not an mpitrace file";
+        return false;
+    }
+
+    ByteReader in{data.data() + sizeof(TRACE_MAGIC), data.data() + data.size()};
+    while (in.ok && in.pos != in.end) {
+        auto type = static_cast<SectionType>(*in.pos++);
+        uint64_t size = in.varint();
+        if (!in.ok || static_cast<uint64_t>(in.end - in.pos) < size) break;
+        ByteReader section{in.pos, in.pos + size};
+        in.pos += size;
+
+        bool ok = true;
+        switch (type) {
+        case SectionType::HEADER:  ok = read_header(section); break;
+        case SectionType::STRINGS: ok = read_strings(section); break;
+        case SectionType::EVENTS:  ok = read_events(section); break;
+        case SectionType::CLOCK:   ok = read_clock(section); break;
+        case SectionType::COMMS:   ok = read_comms(section); break;
+        case SectionType::MODULES: ok = read_modules(section); break;
+        case SectionType::SAMPLES: ok = read_samples(section); break;
+        case SectionType::CONTEXTS: ok = read_contexts(section); break;
+        default: break;  // секция из более новой версии
+        }
+        if (!ok) {
+            _error = path + ": corrupted section";
+            return false;
+        }
+        // Раскладка событий меняется между версиями, блоки чужой версии не читаются
+        if (type == SectionType::HEADER && version != TRACE_VERSION) {
+            _error = path + ": unsupported format version " + std::to_string(version);
+            return false;
+        }
+    }
+    if (!in.ok) {
+        // Обрезанный хвост (процесс упал): прочитанное остаётся доступным
+        _error = path + ": truncated";
+    }
+    return true;
+}
+
+bool TraceReader::read_header(ByteReader& in) {
+    version = static_cast<uint32_t>(in.varint());
+    rank = static_cast<int>(in.varint());
+    clock = in.string();
+    unit = in.string();
+    system_start_us = in.varint();
+    init_duration_ns = in.varint();
+    return in.ok;
+}
+
+bool TraceReader::read_strings(ByteReader& in) {
+    uint64_t first = in.varint();
+    uint64_t count = in.varint();
+    if (!in.ok) return false;
+    if (names.size() < first + count) names.resize(first + count);
+    for (uint64_t i = 0; i < count && in.ok; i++) names[first + i] = in.string();
+    return in.ok;
+}
+
+bool TraceReader::read_events(ByteReader& in) {
+    Block block;
+    block.count = in.varint();
+    block.min_start = in.varint();
+    block.max_end = in.varint();
+    block.first_event = events.size();
+    if (!in.ok) return false;
+
+    events.reserve(events.size() + block.count);
+    contexts.reserve(contexts.size() + block.count);
+    uint64_t previous = block.min_start;
+    uint32_t previous_id = UINT32_MAX;
+    for (size_t i = 0; i < block.count && in.ok; i++) {
+        EventRecord event{};
+        event.start = previous + static_cast<uint64_t>(in.zigzag());
+        event.end = event.start + in.varint();
+        event.name = static_cast<uint16_t>(in.varint());
+        event.flags = static_cast<uint16_t>(in.varint());
+        event.peer = static_cast<int32_t>(in.zigzag());
+        event.comm = static_cast<uint32_t>(in.varint()) - 1;
+        event.data = static_cast<uint32_t>(in.varint());
+        event.tag = static_cast<int32_t>(in.zigzag());
+        event.link = static_cast<uint32_t>(in.varint()) - 1;
+        event.bytes = in.varint();
+        event.offset = in.varint() - 1;
+        event.id = previous_id + 1 + static_cast<uint32_t>(in.zigzag());
+        event.thread = static_cast<uint32_t>(in.varint());
+        uint32_t context = static_cast<uint32_t>(in.varint()) - 1;
+        previous = event.start;
+        previous_id = event.id;
+        events.push_back(event);
+        contexts.push_back(context);
+    }
+    blocks.push_back(block);
+    return in.ok;
+}
+
+bool TraceReader::read_clock(ByteReader& in) {
+    start_ticks = in.varint();
+    ns_per_tick = in.raw<double>();
+    return in.ok;
+}
+
+bool TraceReader::read_comms(ByteReader& in) {
+    uint64_t count = in.varint();
+    for (uint64_t i = 0; i < count && in.ok; i++) {
+        uint32_t id = static_cast<uint32_t>(in.varint());
+        uint64_t size = in.varint();
+        if (!in.ok || size > static_cast<uint64_t>(in.end - in.pos)) return false;
+        std::vector<int32_t>& ranks = comms[id];
+        ranks.resize(size);
+        for (uint64_t j = 0; j < size && in.ok; j++) ranks[j] = static_cast<int32_t>(in.varint());
+    }
+    return in.ok;
+}
+
+bool TraceReader::read_modules(ByteReader& in) {
+    uint64_t count = in.varint();
+    for (uint64_t i = 0; i < count && in.ok; i++) {
+        ModuleDefinition module;
+        module.path = in.string();
+        module.base = in.varint();
+        module.low = in.varint();
+        module.high = in.varint();
+        if (in.ok) modules.push_back(std::move(module));
+    }
+    return in.ok;
+}
+
+bool TraceReader::read_samples(ByteReader& in) {
+    uint64_t count = in.varint();
+    for (uint64_t i = 0; i < count && in.ok; i++) {
+        StackSample sample;
+        sample.time = in.varint();
+        sample.thread = static_cast<uint32_t>(in.varint());
+        uint64_t depth = in.varint();
+        for (uint64_t j = 0; j < depth && in.ok; j++) sample.frames.push_back(in.varint());
+        if (in.ok) samples.push_back(std::move(sample));
+    }
+    return in.ok;
+}
+
+// Родитель записан раньше потомка, поэтому цепочка не зацикливается
+bool TraceReader::read_contexts(ByteReader& in) {
+    uint64_t count = in.varint();
+    for (uint64_t i = 0; i < count && in.ok; i++) {
+        ContextNode node;
+        node.parent = static_cast<uint32_t>(in.varint()) - 1;
+        node.address = in.varint();
+        if (!in.ok) break;
+        if (node.parent != NO_CONTEXT && node.parent >= context_nodes.size()) return false;
+        context_nodes.push_back(node);
+    }
+    return in.ok;
+}
+
+std::vector<uint64_t> TraceReader::call_path(size_t event) const {
+    std::vector<uint64_t> path;
+    uint32_t node = event < contexts.size() ? contexts[event] : NO_CONTEXT;
+    while (node != NO_CONTEXT && node < context_nodes.size()) {
+        path.push_back(context_nodes[node].address);
+        node = context_nodes[node].parent;
+    }
+    return path;
+}
+
+std::vector<int> TraceReader::participants_of(const EventRecord& event) const {
+    const std::vector<int32_t>* ranks = (event.flags & INSTANCE) ? members(event.comm) : nullptr;
+    if (!ranks) return {};
+    std::vector<int> result;
+    result.reserve(ranks->size());
+    for (int32_t member : *ranks) {
+        if (member != rank) result.push_back(member);
+    }
+    return result;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "trace_format.h"
+
+// Чтение trace_rank_N целиком в память.
+// События остаются в тиках, to_ns() переводит их в наносекунды от начала MPI_Init.
+class TraceReader {
+public:
+    struct Block {
+        uint64_t min_start;
+        uint64_t max_end;
+        size_t first_event;
+        size_t count;
+    };
+
+    uint32_t version = 0;
+    int rank = -1;
+    std::string clock;
+    std::string unit;
+    uint64_t system_start_us = 0;
+    uint64_t init_duration_ns = 0;
+    uint64_t start_ticks = 0;
+    double ns_per_tick = 1.0;
+
+    std::vector<std::string> names;
+    std::vector<EventRecord> events;
+    std::vector<uint32_t> contexts;  // узел дерева вызовов по номеру события, NO_CONTEXT - нет
+    std::vector<Block> blocks;
+    std::unordered_map<uint32_t, std::vector<int32_t>> comms;  // id -> ранги в MPI_COMM_WORLD
+    std::vector<ModuleDefinition> modules;                      // карта загрузки (FUNCTION)
+    std::vector<StackSample> samples;                           // в порядке записи, не по времени
+    std::vector<ContextNode> context_nodes;                     // дерево вызовов (MPITRACE_CONTEXT)
+
+    bool open(const std::string& path);
+
+    const std::string& name(const EventRecord& event) const {
+        static const std::string unknown = "?";
+        return event.name < names.size() ? names[event.name] : unknown;
+    }
+
+    int64_t to_ns(uint64_t ticks) const {
+        return static_cast<int64_t>(init_duration_ns) +
+               static_cast<int64_t>(static_cast<int64_t>(ticks - start_ticks) * ns_per_tick);
+    }
+
+    // Путь вызова события: адреса от места вызова MPI к внешним функциям
+    std::vector<uint64_t> call_path(size_t event) const;
+
+    // Остальные участники коллектива (INSTANCE) по составу коммуникатора из COMMS
+    std::vector<int> participants_of(const EventRecord& event) const;
+
+    // Состав коммуникатора; nullptr, если его нет в секции COMMS
+    const std::vector<int32_t>* members(uint32_t comm) const {
+        auto it = comms.find(comm);
+        return it != comms.end() ? &it->second : nullptr;
+    }
+
+    const std::string& error() const {
+        return _error;
+    }
+
+private:
+    std::string _error;
+
+    bool read_header(ByteReader& in);
+    bool read_strings(ByteReader& in);
+    bool read_events(ByteReader& in);
+    bool read_clock(ByteReader& in);
+    bool read_comms(ByteReader& in);
+    bool read_modules(ByteReader& in);
+    bool read_samples(ByteReader& in);
+    bool read_contexts(ByteReader& in);
+};
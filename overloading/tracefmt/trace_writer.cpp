@@ -0,0 +1,149 @@
+#include "trace_writer.h"
+#include <algorithm>
+
+bool TraceWriter::open(const std::string& path) {
+    _file.open(path, std::ios::binary | std::ios::trunc);
+    if (!_file.is_open()) return false;
+    _file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    return true;
+}
+
+void TraceWriter::close() {
+    flush_block();
+    _file.close();
+}
+
+void TraceWriter::write_section(SectionType type, const std::string& payload) {
+    std::string head;
+    head.push_back(static_cast<char>(type));
+    put_varint(head, payload.size());
+    _file.write(head.data(), head.size());
+    _file.write(payload.data(), payload.size());
+}
+
+void TraceWriter::write_header(int rank, std::string_view clock, std::string_view unit,
+                               uint64_t system_start_us, uint64_t init_duration_ns) {
+    std::string payload;
+    put_varint(payload, TRACE_VERSION);
+    put_varint(payload, rank);
+    put_string(payload, clock);
+    put_string(payload, unit);
+    put_varint(payload, system_start_us);
+    put_varint(payload, init_duration_ns);
+    write_section(SectionType::HEADER, payload);
+}
+
+void TraceWriter::write_strings(uint32_t first_id, const std::vector<std::string>& strings) {
+    if (strings.empty()) return;
+    std::string payload;
+    put_varint(payload, first_id);
+    put_varint(payload, strings.size());
+    for (const std::string& str : strings) put_string(payload, str);
+    write_section(SectionType::STRINGS, payload);
+}
+
+void TraceWriter::write_clock(uint64_t start_ticks, double ns_per_tick) {
+    flush_block();
+    std::string payload;
+    put_varint(payload, start_ticks);
+    payload.append(reinterpret_cast<const char*>(&ns_per_tick), sizeof(ns_per_tick));
+    write_section(SectionType::CLOCK, payload);
+}
+
+void TraceWriter::write_comms(const std::vector<CommDefinition>& comms) {
+    if (comms.empty()) return;
+    std::string payload;
+    put_varint(payload, comms.size());
+    for (const CommDefinition& comm : comms) {
+        put_varint(payload, comm.id);
+        put_varint(payload, comm.ranks.size());
+        for (int32_t rank : comm.ranks) put_varint(payload, static_cast<uint32_t>(rank));
+    }
+    write_section(SectionType::COMMS, payload);
+}
+
+void TraceWriter::write_modules(const std::vector<ModuleDefinition>& modules) {
+    if (modules.empty()) return;
+    std::string payload;
+    put_varint(payload, modules.size());
+    for (const ModuleDefinition& module : modules) {
+        put_string(payload, module.path);
+        put_varint(payload, module.base);
+        put_varint(payload, module.low);
+        put_varint(payload, module.high);
+    }
+    write_section(SectionType::MODULES, payload);
+}
+
+void TraceWriter::write_samples(const std::vector<StackSample>& samples) {
+    for (size_t first = 0; first < samples.size(); first += BLOCK_EVENTS) {
+        size_t count = std::min<size_t>(BLOCK_EVENTS, samples.size() - first);
+        std::string payload;
+        put_varint(payload, count);
+        for (size_t i = first; i < first + count; i++) {
+            const StackSample& sample = samples[i];
+            put_varint(payload, sample.time);
+            put_varint(payload, sample.thread);
+            put_varint(payload, sample.frames.size());
+            for (uint64_t frame : sample.frames) put_varint(payload, frame);
+        }
+        write_section(SectionType::SAMPLES, payload);
+    }
+}
+
+void TraceWriter::write_contexts(const std::vector<ContextNode>& nodes) {
+    if (nodes.empty()) return;
+    std::string payload;
+    put_varint(payload, nodes.size());
+    for (const ContextNode& node : nodes) {
+        put_varint(payload, static_cast<uint32_t>(node.parent + 1));
+        put_varint(payload, node.address);
+    }
+    write_section(SectionType::CONTEXTS, payload);
+}
+
+void TraceWriter::add_event(const EventRecord& event, uint32_t context) {
+    _pending.push_back(event);
+    _pending_contexts.push_back(context);
+    if (event.start < _block_min_start) _block_min_start = event.start;
+    if (event.end > _block_max_end) _block_max_end = event.end;
+    if (_pending.size() >= BLOCK_EVENTS) flush_block();
+}
+
+// Диапазон времени блока известен только после набора всех событий,
+// поэтому блок кодируется целиком при сбросе
+void TraceWriter::flush_block() {
+    if (_pending.empty()) return;
+    _block.clear();
+    put_varint(_block, _pending.size());
+    put_varint(_block, _block_min_start);
+    put_varint(_block, _block_max_end);
+
+    uint64_t previous = _block_min_start;
+    uint32_t previous_id = UINT32_MAX;
+    for (size_t i = 0; i < _pending.size(); i++) {
+        const EventRecord& event = _pending[i];
+        put_zigzag(_block, static_cast<int64_t>(event.start - previous));
+        put_varint(_block, event.end - event.start);
+        put_varint(_block, event.name);
+        put_varint(_block, event.flags);
+        put_zigzag(_block, event.peer);
+        put_varint(_block, static_cast<uint32_t>(event.comm + 1));
+        put_varint(_block, event.data);
+        put_zigzag(_block, event.tag);
+        put_varint(_block, static_cast<uint32_t>(event.link + 1));
+        put_varint(_block, event.bytes);
+        put_varint(_block, event.offset + 1);
+        put_zigzag(_block, static_cast<int32_t>(event.id - previous_id - 1));
+        put_varint(_block, event.thread);
+        put_varint(_block, static_cast<uint32_t>(_pending_contexts[i] + 1));
+        previous = event.start;
+        previous_id = event.id;
+    }
+    write_section(SectionType::EVENTS, _block);
+
+    _pending.clear();
+    _pending_contexts.clear();
+    _block_min_start = UINT64_MAX;
+    _block_max_end = 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "trace_format.h"
+
+// Запись trace_rank_N по секциям. События копятся в блок и
+// сбрасываются секцией EVENTS при заполнении или в flush_block().
+class TraceWriter {
+private:
+    std::ofstream _file;
+    std::string _block;
+    uint64_t _block_min_start = UINT64_MAX;
+    uint64_t _block_max_end = 0;
+    std::vector<EventRecord> _pending;
+    std::vector<uint32_t> _pending_contexts;
+
+    void write_section(SectionType type, const std::string& payload);
+
+public:
+    static constexpr uint32_t BLOCK_EVENTS = 4096;
+
+    bool open(const std::string& path);
+    void close();
+
+    void write_header(int rank, std::string_view clock, std::string_view unit,
+                      uint64_t system_start_us, uint64_t init_duration_ns);
+    // strings получают индексы first_id, first_id + 1, ...
+    void write_strings(uint32_t first_id, const std::vector<std::string>& strings);
+    void write_clock(uint64_t start_ticks, double ns_per_tick);
+    void write_comms(const std::vector<CommDefinition>& comms);
+    void write_modules(const std::vector<ModuleDefinition>& modules);
+    // Секциями по BLOCK_EVENTS снимков
+    void write_samples(const std::vector<StackSample>& samples);
+    void write_contexts(const std::vector<ContextNode>& nodes);
+
+    // context - узел дерева вызовов (секция CONTEXTS)
+    void add_event(const EventRecord& event, uint32_t context = NO_CONTEXT);
+    void flush_block();
+};
@@ -0,0 +1,51 @@
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include "collective_match.h"
+
+// Экземпляры коллективов по всем рангам каталога TracesN (мкс):
+// имя коммуникатор номер участники/размер вход_разброс выход_разброс ожидание
+// и итог по функциям: число экземпляров, суммарное ожидание, худший разброс входа
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: tracecoll TracesN\n";
+        return 1;
+    }
+    std::vector<TraceReader> traces;
+    std::string prefix = std::string(argv[1]) + "/trace_rank_";
+    while (std::filesystem::exists(prefix + std::to_string(traces.size()))) {
+        std::string path = prefix + std::to_string(traces.size());
+        traces.emplace_back();
+        if (!traces.back().open(path)) {
+            std::cerr << traces.back().error() << "\n";
+            return 1;
+        }
+        if (!traces.back().error().empty()) std::cerr << traces.back().error() << "\n";
+    }
+    if (traces.empty()) {
+        std::cerr << "no traces in " << argv[1] << "\n";
+        return 1;
+    }
+
+    struct Total {
+        size_t count = 0;
+        int64_t wait = 0;
+        int64_t max_entry_skew = 0;
+    };
+    std::map<std::string, Total> totals;
+    for (const CollectiveInstance& instance : match_collectives(traces)) {
+        std::cout << instance.name << " " << instance.comm << " " << instance.sequence
+                  << " " << instance.members.size() << "/" << instance.size
+                  << " " << instance.entry_skew() / 1000 << " " << instance.exit_skew() / 1000
+                  << " " << instance.wait / 1000 << "\n";
+        Total& total = totals[instance.name];
+        total.count++;
+        total.wait += instance.wait;
+        total.max_entry_skew = std::max(total.max_entry_skew, instance.entry_skew());
+    }
+    std::cout << "# function instances wait_us max_entry_skew_us\n";
+    for (const auto& [name, total] : totals) {
+        std::cout << "# " << name << " " << total.count << " " << total.wait / 1000 << " " << total.max_entry_skew / 1000 << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include <iostream>
+#include <unordered_set>
+#include "sample_attribution.h"
+#include "symbolizer.h"
+#include "trace_reader.h"
+
+// Печать бинарной трассы в прежнем текстовом виде (мкс):
+// COMM: коммуникатор ранги... (состав из секции COMMS), затем события:
+// имя начало конец коммуникатор [партнёр] [tag=тег] [bytes=байты] [#id начала операции]
+// [thread=поток, если не первый] [id=номер, если на событие есть ссылки]
+// [ctx=узел дерева вызовов]
+// или для ряда опросов: ... polls=число busy=время в вызовах;
+// для окон RMA: ... win=окно [epoch=#id события, открывшего эпоху];
+// для MPI-IO: ... file=файл [offset=смещение] [collective];
+// для POSIX: ... [bytes=байты] fd=дескриптор [offset=смещение], ряд мелких
+// передач: ... bytes=сумма calls=число busy=время в вызовах fd=дескриптор;
+// для памяти: крупное выделение ... bytes=размер heap, показание счётчиков
+// heap ... live=занято peak=максимум allocations=выделений с предыдущего;
+// для OpenMP: ... [count=команда или итерации] [at=конструкция], ряд задач
+// потока: omp_task ... tasks=число busy=время выполнения;
+// для коллективов: ... [root=корень] ... seq=номер вызова на коммуникаторе;
+// для регионов: ... region depth=глубина; функции (-finstrument-functions)
+// печатаются под именем из таблицы символов, без него - модуль+смещение.
+// Затем снимки стека (MPITRACE_SAMPLE_US): SAMPLE время [thread=поток]
+// [in=событие во время снимка] [after=последнее завершившееся]: функции от
+// прерванной к вызывающим. В конце дерево вызовов (MPITRACE_CONTEXT):
+// CONTEXT узел [parent=родитель]: функция места вызова
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: tracedump trace_rank_N...\n";
+        return 1;
+    }
+    for (int i = 1; i < argc; i++) {
+        TraceReader trace;
+        if (!trace.open(argv[i])) {
+            std::cerr << trace.error() << "\n";
+            return 1;
+        }
+        if (!trace.error().empty()) std::cerr << trace.error() << "\n";
+
+        std::cout << "RANK: " << trace.rank << " CLOCK: " << trace.clock << "\n";
+        std::cout << "SYSTEM_START_US: " << trace.system_start_us << "\n";
+        for (const auto& [id, ranks] : trace.comms) {
+            std::cout << "COMM: " << static_cast<int32_t>(id);
+            for (int32_t rank : ranks) std::cout << " " << rank;
+            std::cout << "\n";
+        }
+        // События разных потоков перемежаются, поэтому ссылки - по id, а не по позиции
+        std::unordered_set<uint32_t> targets;
+        for (const EventRecord& event : trace.events) {
+            if ((event.flags & COMPLETION) || (event.flags & (WINDOW | INSTANCE)) == WINDOW) targets.insert(event.link);
+        }
+        Symbolizer symbols(trace.modules);
+        auto label = [&](const EventRecord& event) {
+            return (event.flags & FUNCTION) ? symbols.resolve(event.offset) : trace.name(event);
+        };
+        for (size_t e = 0; e < trace.events.size(); e++) {
+            const EventRecord& event = trace.events[e];
+            std::cout << label(event) << " " << trace.to_ns(event.start) / 1000 << " " << trace.to_ns(event.end) / 1000
+                      << " " << static_cast<int32_t>(event.comm);
+            if (event.flags & INSTANCE) {
+                if (event.peer >= 0) std::cout << " root=" << event.peer;
+            } else if (event.peer >= 0) {
+                std::cout << " " << event.peer;
+            }
+            if (event.tag >= 0) std::cout << " tag=" << event.tag;
+            if ((event.flags & POSIX_IO) && (event.flags & POLLS)) {
+                std::cout << " bytes=" << event.bytes << " calls=" << event.link
+                          << " busy=" << static_cast<uint64_t>(event.offset * trace.ns_per_tick) / 1000;
+            } else if ((event.flags & OPENMP) && (event.flags & POLLS)) {
+                std::cout << " tasks=" << event.data << " busy=" << static_cast<uint64_t>(event.bytes * trace.ns_per_tick) / 1000;
+            } else if (event.flags & COUNTER) {
+                std::cout << " live=" << event.bytes << " peak=" << event.offset << " allocations=" << event.data;
+            } else if (event.flags & POLLS) {
+                std::cout << " polls=" << event.data << " busy=" << static_cast<uint64_t>(event.bytes * trace.ns_per_tick) / 1000;
+            } else if (event.bytes) {
+                std::cout << " bytes=" << event.bytes;
+            }
+            if (event.flags & COMPLETION) std::cout << " #" << event.link;
+            if (event.flags & INSTANCE) std::cout << " seq=" << event.link;
+            if (event.flags & WINDOW) {
+                std::cout << " win=" << event.data;
+                if (!(event.flags & INSTANCE) && event.link != NO_LINK) std::cout << " epoch=#" << event.link;
+            }
+            if (event.flags & FILE_IO) {
+                std::cout << " file=" << event.data;
+                if (event.offset != NO_OFFSET) std::cout << " offset=" << event.offset;
+                if (event.flags & COLLECTIVE) std::cout << " collective";
+            }
+            if (event.flags & POSIX_IO) {
+                std::cout << " fd=" << static_cast<int32_t>(event.data);
+                if (!(event.flags & POLLS) && event.offset != NO_OFFSET) std::cout << " offset=" << event.offset;
+            }
+            if (event.flags & HEAP) std::cout << " heap";
+            if ((event.flags & OPENMP) && !(event.flags & POLLS)) {
+                if (event.data) std::cout << " count=" << event.data;
+                if (event.offset != NO_OFFSET) std::cout << " at=" << symbols.resolve(event.offset);
+            }
+            if (event.flags & REGION) std::cout << " region depth=" << event.data;
+            if (event.thread) std::cout << " thread=" << event.thread;
+            if (targets.count(event.id)) std::cout << " id=" << event.id;
+            if (trace.contexts[e] != NO_CONTEXT) std::cout << " ctx=" << trace.contexts[e];
+            std::cout << "\n";
+        }
+        std::vector<SampleOwner> owners = attribute_samples(trace);
+        for (size_t s = 0; s < trace.samples.size(); s++) {
+            const StackSample& sample = trace.samples[s];
+            std::cout << "SAMPLE " << trace.to_ns(sample.time) / 1000;
+            if (sample.thread) std::cout << " thread=" << sample.thread;
+            if (owners[s].inside != NO_EVENT) std::cout << " in=" << label(trace.events[owners[s].inside]);
+            if (owners[s].after != NO_EVENT) std::cout << " after=" << label(trace.events[owners[s].after]);
+            std::cout << ":";
+            for (uint64_t frame : sample.frames) std::cout << " " << symbols.resolve(frame);
+            std::cout << "\n";
+        }
+        for (size_t n = 0; n < trace.context_nodes.size(); n++) {
+            const ContextNode& node = trace.context_nodes[n];
+            std::cout << "CONTEXT " << n;
+            if (node.parent != NO_CONTEXT) std::cout << " parent=" << node.parent;
+            std::cout << ": " << symbols.resolve(node.address) << "\n";
+        }
+    }
+    return 0;
+}
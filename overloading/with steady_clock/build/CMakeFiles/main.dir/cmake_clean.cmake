@@ -1,13 +0,0 @@
-file(REMOVE_RECURSE
-  "CMakeFiles/main.dir/main.cpp.obj"
-  "CMakeFiles/main.dir/main.cpp.obj.d"
-  "libmain.dll.a"
-  "main.exe"
-  "main.exe.manifest"
-  "main.pdb"
-)
-
-# Per-language clean rules from dependency scanning.
-foreach(lang CXX)
-  include(CMakeFiles/main.dir/cmake_clean_${lang}.cmake OPTIONAL)
-endforeach()
@@ -1,59 +0,0 @@
-# CMAKE generated file: DO NOT EDIT!
-# Generated by "MinGW Makefiles" Generator, CMake Version 4.1
-
-# The generator used is:
-set(CMAKE_DEPENDS_GENERATOR "MinGW Makefiles")
-
-# The top level Makefile was generated from the following files:
-set(CMAKE_MAKEFILE_DEPENDS
-  "CMakeCache.txt"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeCXXInformation.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeCommonLanguageInclude.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeGenericSystem.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeInitializeConfigs.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeLanguageInformation.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeRCInformation.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeSystemSpecificInformation.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/CMakeSystemSpecificInitialize.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Compiler/CMakeCommonCompilerMacros.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Compiler/GNU-CXX.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Compiler/GNU.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/FindMPI.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/FindPackageHandleStandardArgs.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/FindPackageMessage.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/FindPkgConfig.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Internal/CMakeCXXLinkerInformation.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Internal/CMakeCommonLinkerInformation.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Linker/GNU-CXX.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Linker/GNU.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Linker/GNU.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Linker/Windows-GNU-CXX.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Linker/Windows-GNU.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Windows-GNU-CXX-ABI.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Windows-GNU-CXX.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Windows-GNU.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Windows-Initialize.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Windows-windres.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/Windows.cmake"
-  "C:/msys64/mingw64/share/cmake/Modules/Platform/WindowsPaths.cmake"
-  "D:/institute/profiling-tools/overloading/with system_clock/CMakeLists.txt"
-  "CMakeFiles/4.1.1/CMakeCXXCompiler.cmake"
-  "CMakeFiles/4.1.1/CMakeRCCompiler.cmake"
-  "CMakeFiles/4.1.1/CMakeSystem.cmake"
-  )
-
-# The corresponding makefile is:
-set(CMAKE_MAKEFILE_OUTPUTS
-  "Makefile"
-  "CMakeFiles/cmake.check_cache"
-  )
-
-# Byproducts of CMake generate step:
-set(CMAKE_MAKEFILE_PRODUCTS
-  "CMakeFiles/CMakeDirectoryInformation.cmake"
-  )
-
-# Dependency information for all targets:
-set(CMAKE_DEPEND_INFO_FILES
-  "CMakeFiles/main.dir/DependInfo.cmake"
-  )